@@ -0,0 +1,131 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Includes...
+
+    // Ours...
+    #include "arena.h"
+
+    // POSIX...
+    #include <sys/mman.h>
+    #include <unistd.h>
+
+    // Standard C++...
+    #include <cstring>
+
+// Older systems only spell it the BSD way...
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+    #define MAP_ANONYMOUS MAP_ANON
+#endif
+
+// Constructor...
+SecureArena::SecureArena(const size_t Bytes)
+    : m_Base(nullptr),
+      m_Size(0),
+      m_Used(0),
+      m_Locked(false)
+{
+    // Round up to a whole number of pages...
+    const size_t PageBytes = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t Size = (Bytes + PageBytes - 1) / PageBytes * PageBytes;
+
+    // Reserve...
+    void *Mapping = ::mmap(
+        nullptr, Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(Mapping == MAP_FAILED)
+        return;
+    m_Base = static_cast<uint8_t *>(Mapping);
+    m_Size = Size;
+
+#ifdef MADV_DONTDUMP
+    // Keep out of core dumps. Nothing to be done if the kernel is too old...
+  ::madvise(m_Base, m_Size, MADV_DONTDUMP);
+#endif
+
+    // Nothing needs to be locked yet...
+    m_Locked.store(true, std::memory_order_relaxed);
+}
+
+// Carve out the given number of bytes at the given alignment...
+void *SecureArena::Allocate(const size_t Bytes, const size_t Alignment)
+{
+    // Mapping failed...
+    if(!m_Base)
+        return nullptr;
+
+    // Align the start, since the base is page aligned an offset is enough...
+    const size_t Start = (m_Used + Alignment - 1) & ~(Alignment - 1);
+
+    // Exhausted...
+    if(Start > m_Size || Bytes > m_Size - Start)
+        return nullptr;
+
+    // Hand it out...
+    m_Used = Start + Bytes;
+    return m_Base + Start;
+}
+
+// Lock the pages holding the given part of the arena into memory...
+bool SecureArena::Lock(const void *Buffer, const size_t Bytes)
+{
+    // Locked...
+    if(TryLock(Buffer, Bytes))
+        return true;
+
+    // Remember that we couldn't...
+    m_Locked.store(false, std::memory_order_relaxed);
+    return false;
+}
+
+// Lock the pages holding the given part of the arena into memory, without
+//  remembering a failure...
+bool SecureArena::TryLock(const void *Buffer, const size_t Bytes)
+{
+    // Widen to the pages it touches, since the base is page aligned offsets
+    //  are enough...
+    const size_t PageBytes = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t Offset = static_cast<const uint8_t *>(Buffer) - m_Base;
+    const size_t Start  = Offset / PageBytes * PageBytes;
+    const size_t End    =
+        (Offset + Bytes + PageBytes - 1) / PageBytes * PageBytes;
+
+    // Keep out of swap. Pages already locked are not counted again. This
+    //  fails if it would exceed RLIMIT_MEMLOCK, in which case the memory still
+    //  works unlocked...
+    return (::mlock(m_Base + Start, End - Start) == 0);
+}
+
+// Zero everything ever allocated...
+void SecureArena::Wipe()
+{
+    if(m_Base)
+        SecureWipe(m_Base, m_Used);
+}
+
+// Wipe, unlock and release...
+SecureArena::~SecureArena()
+{
+    // Nothing was mapped...
+    if(!m_Base)
+        return;
+
+    // Wipe before the pages can go anywhere else...
+    Wipe();
+
+    // Release, which also unlocks whatever was locked...
+  ::munmap(m_Base, m_Size);
+}
+
+// Zero the given buffer in a way the compiler can't optimize away...
+void SecureWipe(void *Buffer, const size_t Bytes)
+{
+    // Zero...
+  ::memset(Buffer, 0, Bytes);
+
+    // Tell the compiler the zeroes may be read, so the stores above are never
+    //  treated as dead...
+    asm volatile("" : : "r"(Buffer) : "memory");
+}
+
@@ -0,0 +1,96 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Multiple include protection...
+#ifndef _SECURE_ARENA_H_
+#define _SECURE_ARENA_H_
+
+// Includes...
+
+    // Standard C++...
+#ifdef __APPLE__
+    #include <tr1/cstdint>
+#else
+    #include <cstdint>
+#endif
+    #include <atomic>
+    #include <cstddef>
+
+// Storage for key material and buffered output. Carved out of one large
+//  anonymous mapping that is excluded from core dumps, and locked into memory
+//  by the owner so it is never written to swap, all at once where
+//  RLIMIT_MEMLOCK allows or piece by piece as it is put to use where it
+//  doesn't. Allocations are never freed individually; everything is wiped and
+//  released together when the arena is. Not thread safe, except for
+//  IsLocked()...
+class SecureArena
+{
+    // Public methods...
+    public:
+
+        // Constructor. Reserves at least the given number of bytes. Check
+        //  IsOpen() afterwards...
+        explicit SecureArena(const size_t Bytes);
+
+        // Carve out the given number of bytes at the given alignment, which
+        //  must be a power of two no larger than a page. Returns nullptr once
+        //  the arena is exhausted...
+        void *Allocate(const size_t Bytes, const size_t Alignment);
+
+        // Get the number of bytes reserved...
+        size_t GetSize() const { return m_Size; }
+
+        // Check if everything passed to Lock() so far is locked into memory.
+        //  Hosts with a small RLIMIT_MEMLOCK can still use the rest, just
+        //  without that guarantee...
+        bool IsLocked() const
+            { return m_Locked.load(std::memory_order_relaxed); }
+
+        // Lock the pages holding the given part of the arena into memory,
+        //  returning false if that would exceed RLIMIT_MEMLOCK, after which
+        //  IsLocked() is false. Locks are not inherited by a child after
+        //  fork(), which must lock them again...
+        bool Lock(const void *Buffer, const size_t Bytes);
+
+        // As Lock(), but failing leaves IsLocked() as it was, for callers
+        //  with somewhere else to fall back to...
+        bool TryLock(const void *Buffer, const size_t Bytes);
+
+        // Check if the mapping was created successfully...
+        bool IsOpen() const { return (m_Base != nullptr); }
+
+        // Zero everything ever allocated. Nothing may be using it...
+        void Wipe();
+
+        // Wipe, unlock and release...
+       ~SecureArena();
+
+    // Private methods...
+    private:
+
+        // Forbid copy constructor and assignment...
+        SecureArena(const SecureArena &);
+        SecureArena &operator=(const SecureArena &);
+
+    // Protected attributes...
+    protected:
+
+        // Start of the mapping and its size...
+        uint8_t    *m_Base;
+        size_t      m_Size;
+
+        // Bytes handed out so far...
+        size_t      m_Used;
+
+        // Whether every part we were asked to lock could be...
+        std::atomic<bool> m_Locked;
+};
+
+// Zero the given buffer in a way the compiler can't optimize away, even if
+//  the buffer is never read again...
+void SecureWipe(void *Buffer, const size_t Bytes);
+
+#endif
+
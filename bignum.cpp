@@ -0,0 +1,587 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Includes...
+
+    // Ours...
+    #include "arena.h"
+    #include "bignum.h"
+
+    // Standard C++...
+    #include <algorithm>
+    #include <cstring>
+
+// Using the standard namespace...
+using namespace std;
+
+// Double width product and carry arithmetic...
+typedef unsigned __int128 uint128_t;
+
+// Small primes are sieved up to here...
+static const uint32_t   SievePrimeLimit = 65536;
+
+// Odd offsets from each random starting point sieved before giving up on it.
+//  Comfortably wider than the average gap between primes of the largest size
+//  we allow...
+static const size_t     SieveWindow     = 8192;
+
+// Get every odd prime below the sieve limit, computed once...
+static const vector<uint32_t> &GetSmallPrimes()
+{
+    // Sieve of Eratosthenes the first time through...
+    static const vector<uint32_t> Primes = []()
+    {
+        vector<bool>     Composite(SievePrimeLimit, false);
+        vector<uint32_t> Found;
+        for(uint32_t Value = 3; Value < SievePrimeLimit; Value += 2)
+        {
+            if(Composite[Value])
+                continue;
+            Found.push_back(Value);
+            for(uint32_t Multiple = Value * Value; Multiple < SievePrimeLimit; Multiple += 2 * Value)
+                Composite[Multiple] = true;
+        }
+        return Found;
+    }();
+
+    // Done...
+    return Primes;
+}
+
+// Drop leading zero limbs...
+static void Normalize(BigNumber &Number)
+{
+    while(!Number.empty() && !Number.back())
+        Number.pop_back();
+}
+
+// Compare two numbers of the given length, returning negative, zero or
+//  positive...
+static int Compare(const uint64_t *Left, const uint64_t *Right, const size_t Limbs)
+{
+    for(size_t Index = Limbs; Index-- > 0;)
+    {
+        if(Left[Index] != Right[Index])
+            return (Left[Index] < Right[Index]) ? -1 : 1;
+    }
+    return 0;
+}
+
+// Add the right number to the left in place, returning the carry...
+static uint64_t Add(uint64_t *Left, const uint64_t *Right, const size_t Limbs)
+{
+    uint64_t Carry = 0;
+    for(size_t Index = 0; Index < Limbs; ++Index)
+    {
+        const uint128_t Sum =
+            static_cast<uint128_t>(Left[Index]) + Right[Index] + Carry;
+        Left[Index] = static_cast<uint64_t>(Sum);
+        Carry       = static_cast<uint64_t>(Sum >> 64);
+    }
+    return Carry;
+}
+
+// Subtract the right number from the left in place, returning the borrow...
+static uint64_t Subtract(uint64_t *Left, const uint64_t *Right, const size_t Limbs)
+{
+    uint64_t Borrow = 0;
+    for(size_t Index = 0; Index < Limbs; ++Index)
+    {
+        const uint128_t Difference =
+            static_cast<uint128_t>(Left[Index]) - Right[Index] - Borrow;
+        Left[Index] = static_cast<uint64_t>(Difference);
+        Borrow      = static_cast<uint64_t>(Difference >> 64) & 1;
+    }
+    return Borrow;
+}
+
+// Get the remainder after dividing by a small divisor...
+static uint32_t Remainder(const BigNumber &Number, const uint32_t Divisor)
+{
+    uint64_t Result = 0;
+    for(size_t Index = Number.size(); Index-- > 0;)
+        Result = static_cast<uint64_t>(
+            ((static_cast<uint128_t>(Result) << 64) | Number[Index]) % Divisor);
+    return static_cast<uint32_t>(Result);
+}
+
+// Number of Miller-Rabin rounds with random bases for a random candidate of
+//  the given size. These are OpenSSL's counts, which are more than the average
+//  case estimates of Damgard, Landrock and Pomerance need to keep the chance
+//  of a composite passing below 2^-80 from 100 bits up, as tabulated in the
+//  Handbook of Applied Cryptography, table 4.4. The margin costs little beside
+//  sieving. Below 100 bits those estimates don't apply and only the worst case
+//  bound of 4^-rounds holds, 2^-54 at 27 rounds and 2^-68 at 34...
+static unsigned MillerRabinRounds(const size_t Bits)
+{
+    if(Bits >= 3747) return 3;
+    if(Bits >= 1345) return 4;
+    if(Bits >= 476)  return 5;
+    if(Bits >= 400)  return 6;
+    if(Bits >= 347)  return 7;
+    if(Bits >= 308)  return 8;
+    if(Bits >= 55)   return 27;
+    return 34;
+}
+
+// Arithmetic modulo a fixed odd number in Montgomery form, where each value x
+//  is held as xR mod n for R = 2^(64 * limbs). Multiplication then needs no
+//  division...
+class Montgomery
+{
+    // Public methods...
+    public:
+
+        // Constructor...
+        explicit Montgomery(const BigNumber &Modulus)
+            : m_Modulus(Modulus),
+              m_Limbs(Modulus.size()),
+              m_Inverse(0),
+              m_One(Modulus.size(), 0),
+              m_RSquared(Modulus.size(), 0),
+              m_Scratch(Modulus.size() + 2, 0)
+        {
+            // Negated inverse of the lowest limb modulo 2^64. An odd number is
+            //  its own inverse to three bits, and each Newton step doubles
+            //  that...
+            uint64_t Inverse = m_Modulus[0];
+            for(unsigned Step = 0; Step < 5; ++Step)
+                Inverse *= 2 - m_Modulus[0] * Inverse;
+            m_Inverse = 0 - Inverse;
+
+            // R mod n, which is one in Montgomery form, then R^2 mod n for
+            //  converting into it, by doubling one repeatedly...
+            BigNumber Value(m_Limbs, 0);
+            Value[0] = 1;
+            for(size_t Bit = 0; Bit < 64 * m_Limbs; ++Bit)
+                Double(Value);
+            m_One = Value;
+            for(size_t Bit = 0; Bit < 64 * m_Limbs; ++Bit)
+                Double(Value);
+            m_RSquared = Value;
+        }
+
+        // Get one, in Montgomery form...
+        const BigNumber &GetOne() const { return m_One; }
+
+        // Multiply two values in Montgomery form...
+        void Multiply(const uint64_t *Left, const uint64_t *Right, uint64_t *Product) const
+        {
+            // Interleaved multiplication and reduction, one limb at a time...
+            uint64_t *Total = &m_Scratch[0];
+          ::memset(Total, 0, (m_Limbs + 2) * sizeof(uint64_t));
+            for(size_t Outer = 0; Outer < m_Limbs; ++Outer)
+            {
+                // Add the left value times this limb of the right...
+                uint64_t Carry = 0;
+                for(size_t Inner = 0; Inner < m_Limbs; ++Inner)
+                {
+                    const uint128_t Sum = static_cast<uint128_t>(Left[Inner]) *
+                        Right[Outer] + Total[Inner] + Carry;
+                    Total[Inner] = static_cast<uint64_t>(Sum);
+                    Carry        = static_cast<uint64_t>(Sum >> 64);
+                }
+                uint128_t Sum = static_cast<uint128_t>(Total[m_Limbs]) + Carry;
+                Total[m_Limbs]      = static_cast<uint64_t>(Sum);
+                Total[m_Limbs + 1]  = static_cast<uint64_t>(Sum >> 64);
+
+                // Add the multiple of the modulus that clears the lowest limb,
+                //  then shift down by one limb...
+                const uint64_t Factor = Total[0] * m_Inverse;
+                Sum = static_cast<uint128_t>(Factor) * m_Modulus[0] + Total[0];
+                Carry = static_cast<uint64_t>(Sum >> 64);
+                for(size_t Inner = 1; Inner < m_Limbs; ++Inner)
+                {
+                    Sum = static_cast<uint128_t>(Factor) * m_Modulus[Inner] +
+                        Total[Inner] + Carry;
+                    Total[Inner - 1] = static_cast<uint64_t>(Sum);
+                    Carry            = static_cast<uint64_t>(Sum >> 64);
+                }
+                Sum = static_cast<uint128_t>(Total[m_Limbs]) + Carry;
+                Total[m_Limbs - 1]  = static_cast<uint64_t>(Sum);
+                Total[m_Limbs]      = Total[m_Limbs + 1] + static_cast<uint64_t>(Sum >> 64);
+            }
+
+            // Result is below twice the modulus, so at most one subtraction...
+            if(Total[m_Limbs] || Compare(Total, &m_Modulus[0], m_Limbs) >= 0)
+                Subtract(Total, &m_Modulus[0], m_Limbs);
+          ::memcpy(Product, Total, m_Limbs * sizeof(uint64_t));
+        }
+
+        // Convert a value below the modulus into Montgomery form...
+        void Convert(const BigNumber &Value, BigNumber &Result) const
+        {
+            BigNumber Padded(Value);
+            Padded.resize(m_Limbs, 0);
+            Result.resize(m_Limbs);
+            Multiply(&Padded[0], &m_RSquared[0], &Result[0]);
+        }
+
+        // Raise a value in Montgomery form to the given power, four exponent
+        //  bits at a time...
+        void Power(const BigNumber &Base, const BigNumber &Exponent, BigNumber &Result) const
+        {
+            // Every power of the base from zero to fifteen...
+            vector<BigNumber> Table(16, BigNumber(m_Limbs));
+            Table[0] = m_One;
+            for(size_t Index = 1; Index < 16; ++Index)
+                Multiply(&Table[Index - 1][0], &Base[0], &Table[Index][0]);
+
+            // Work down from the most significant window...
+            Result = m_One;
+            const size_t Windows = (BigNumberBits(Exponent) + 3) / 4;
+            for(size_t Window = Windows; Window-- > 0;)
+            {
+                // Make room for the next four bits...
+                if(Window + 1 < Windows)
+                {
+                    for(unsigned Square = 0; Square < 4; ++Square)
+                        Multiply(&Result[0], &Result[0], &Result[0]);
+                }
+
+                // And multiply them in...
+                const unsigned Bits = static_cast<unsigned>(
+                    (Exponent[Window / 16] >> ((Window % 16) * 4)) & 0xf);
+                if(Bits)
+                    Multiply(&Result[0], &Table[Bits][0], &Result[0]);
+            }
+
+            // Don't leave powers of what may be a secret lying around...
+            for(size_t Index = 0; Index < 16; ++Index)
+                SecureWipe(&Table[Index][0], m_Limbs * sizeof(uint64_t));
+        }
+
+    // Protected methods...
+    protected:
+
+        // Double a value below the modulus, modulo the modulus...
+        void Double(BigNumber &Value) const
+        {
+            // Shift up one bit...
+            const uint64_t Carry = Value[m_Limbs - 1] >> 63;
+            for(size_t Index = m_Limbs - 1; Index > 0; --Index)
+                Value[Index] = (Value[Index] << 1) | (Value[Index - 1] >> 63);
+            Value[0] <<= 1;
+
+            // Reduce...
+            if(Carry || Compare(&Value[0], &m_Modulus[0], m_Limbs) >= 0)
+                Subtract(&Value[0], &m_Modulus[0], m_Limbs);
+        }
+
+    // Private methods...
+    private:
+
+        // Forbid copy constructor and assignment...
+        Montgomery(const Montgomery &);
+        Montgomery &operator=(const Montgomery &);
+
+    // Protected attributes...
+    protected:
+
+        // Modulus and its size...
+        const BigNumber     m_Modulus;
+        const size_t        m_Limbs;
+
+        // Negated inverse of the modulus' lowest limb modulo 2^64...
+        uint64_t            m_Inverse;
+
+        // R mod n and R^2 mod n...
+        BigNumber           m_One;
+        BigNumber           m_RSquared;
+
+        // Intermediate product, two limbs wider than the modulus...
+        mutable BigNumber   m_Scratch;
+};
+
+// Load a big endian byte string...
+void BigNumberFromBytes(
+    const uint8_t *Bytes, const size_t Count, BigNumber &Number)
+{
+    // Each byte from the least significant end...
+    Number.assign((Count + 7) / 8, 0);
+    for(size_t Index = 0; Index < Count; ++Index)
+        Number[Index / 8] |=
+            static_cast<uint64_t>(Bytes[Count - 1 - Index]) << ((Index % 8) * 8);
+
+    // Drop leading zeroes...
+    Normalize(Number);
+}
+
+// Store as a big endian byte string of exactly the given length...
+void BigNumberToBytes(
+    const BigNumber &Number, uint8_t *Bytes, const size_t Count)
+{
+    for(size_t Index = 0; Index < Count; ++Index)
+        Bytes[Count - 1 - Index] = (Index / 8 < Number.size())
+            ? static_cast<uint8_t>(Number[Index / 8] >> ((Index % 8) * 8))
+            : 0;
+}
+
+// Get the number of significant bits...
+size_t BigNumberBits(const BigNumber &Number)
+{
+    // Skip leading zero limbs...
+    size_t Limbs = Number.size();
+    while(Limbs && !Number[Limbs - 1])
+        --Limbs;
+
+    // Zero...
+    if(!Limbs)
+        return 0;
+
+    // Whole limbs below the most significant one, plus its own bits...
+    return (Limbs - 1) * 64 + (64 - __builtin_clzll(Number[Limbs - 1]));
+}
+
+// Draw a number uniformly from [0, Bound)...
+bool RandomBelow(
+    RandomNumberGenerator  &Generator,
+    const BigNumber        &Bound,
+    BigNumber              &Result,
+    bool                   &CorrectionDetected)
+{
+    // Nothing is below zero...
+    const size_t Bits = BigNumberBits(Bound);
+    if(!Bits)
+        return false;
+
+    // Bound padded out to the limbs we will draw...
+    const size_t Limbs = (Bits + 63) / 64;
+    BigNumber Padded(Bound);
+    Padded.resize(Limbs, 0);
+
+    // Draw as many bits as the bound has until the result is below it, which
+    //  takes fewer than two attempts on average...
+    Result.resize(Limbs);
+    const uint64_t TopMask = (Bits % 64) ? ((1ULL << (Bits % 64)) - 1) : ~0ULL;
+    do
+    {
+        bool Correction = false;
+        Generator.FillRandom64(&Result[0], Limbs, Correction);
+        CorrectionDetected |= Correction;
+        Result[Limbs - 1] &= TopMask;
+    }
+    while(Compare(&Result[0], &Padded[0], Limbs) >= 0);
+
+    // Done...
+    Normalize(Result);
+    return true;
+}
+
+// Check if the given number is prime with Miller-Rabin...
+bool IsProbablePrime(
+    RandomNumberGenerator  &Generator,
+    const BigNumber        &Candidate,
+    bool                   &CorrectionDetected)
+{
+    // Work on a copy without leading zeroes...
+    BigNumber Number(Candidate);
+    Normalize(Number);
+
+    // Small numbers and even numbers...
+    if(Number.empty() || (Number.size() == 1 && Number[0] < 4))
+        return (Number.size() == 1 && Number[0] >= 2);
+    if(!(Number[0] & 1))
+        return false;
+
+    // Write n - 1 as an odd number times a power of two...
+    BigNumber Minus(Number);
+    Minus[0] -= 1;
+    BigNumber Odd(Minus);
+    size_t Twos = 0;
+    while(!(Odd[Twos / 64] & (1ULL << (Twos % 64))))
+        ++Twos;
+    for(size_t Index = 0; Index < Odd.size(); ++Index)
+    {
+        // Shift down by whole limbs...
+        const size_t Source = Index + Twos / 64;
+        const unsigned Shift = Twos % 64;
+        uint64_t Limb = (Source < Minus.size()) ? (Minus[Source] >> Shift) : 0;
+        if(Shift && Source + 1 < Minus.size())
+            Limb |= Minus[Source + 1] << (64 - Shift);
+        Odd[Index] = Limb;
+    }
+    Normalize(Odd);
+
+    // Arithmetic modulo the candidate, and the values to compare against...
+    const Montgomery Arithmetic(Number);
+    const BigNumber &One = Arithmetic.GetOne();
+    BigNumber MinusOne(Number);
+    Subtract(&MinusOne[0], &One[0], Number.size());
+
+    // Bases are drawn from [2, n - 2], so draw below n - 3 and add two...
+    BigNumber BaseBound(Number), Three(Number.size(), 0), Two(Number.size(), 0);
+    Three[0] = 3;
+    Two[0] = 2;
+    Subtract(&BaseBound[0], &Three[0], Number.size());
+    Normalize(BaseBound);
+
+    // Each round with a fresh random base...
+    const unsigned Rounds = MillerRabinRounds(BigNumberBits(Number));
+    BigNumber Base, Converted, Value;
+    for(unsigned Round = 0; Round < Rounds; ++Round)
+    {
+        // Draw a base...
+        if(!RandomBelow(Generator, BaseBound, Base, CorrectionDetected))
+            Base.assign(1, 0);
+        Base.resize(Number.size(), 0);
+        Add(&Base[0], &Two[0], Number.size());
+
+        // Raise it to the odd part of n - 1...
+        Arithmetic.Convert(Base, Converted);
+        Arithmetic.Power(Converted, Odd, Value);
+
+        // Passes straight away...
+        if(Value == One || Value == MinusOne)
+            continue;
+
+        // Otherwise square until we reach n - 1...
+        bool Witness = true;
+        for(size_t Square = 1; Square < Twos; ++Square)
+        {
+            Arithmetic.Multiply(&Value[0], &Value[0], &Value[0]);
+            if(Value == MinusOne)
+            {
+                Witness = false;
+                break;
+            }
+            if(Value == One)
+                break;
+        }
+
+        // This base proves the candidate composite...
+        if(Witness)
+            return false;
+    }
+
+    // Probably prime...
+    return true;
+}
+
+// Search for a random prime of exactly the given number of bits...
+bool RandomPrime(
+    RandomNumberGenerator      &Generator,
+    const size_t                Bits,
+    const std::atomic<bool>    &Stop,
+    BigNumber                  &Prime,
+    bool                       &CorrectionDetected)
+{
+    // Out of range...
+    if(Bits < 2 || Bits > MaximumPrimeBits)
+        return false;
+
+    // Small primes to sieve with...
+    const vector<uint32_t> &SmallPrimes = GetSmallPrimes();
+
+    // Everything below the sieve limit can be checked exactly by trial
+    //  division, so just draw until we hit one...
+    if(Bits <= 16)
+    {
+        while(!Stop.load(memory_order_relaxed))
+        {
+            // Draw with the top two and bottom bits set...
+            bool Correction = false;
+            uint32_t Value = Generator.GetRandom32(Correction);
+            CorrectionDetected |= Correction;
+            Value = (Value & ((1U << Bits) - 1)) | (3U << (Bits - 2)) | 1U;
+
+            // Check every odd prime no larger than its square root...
+            bool Composite = false;
+            for(size_t Index = 0;
+                !Composite && Index < SmallPrimes.size() &&
+                SmallPrimes[Index] * SmallPrimes[Index] <= Value;
+                ++Index)
+                Composite = (Value % SmallPrimes[Index] == 0);
+
+            // Found one...
+            if(!Composite)
+            {
+                Prime.assign(1, Value);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Limbs needed, and the mask for the most significant one...
+    const size_t    Limbs   = (Bits + 63) / 64;
+    const unsigned  TopBits = static_cast<unsigned>((Bits - 1) % 64 + 1);
+    const uint64_t  TopMask = (TopBits == 64) ? ~0ULL : ((1ULL << TopBits) - 1);
+    const uint64_t  TopTwo  = (TopBits >= 2) ? (3ULL << (TopBits - 2)) : 1;
+
+    // Working storage...
+    BigNumber       Start(Limbs), Step(Limbs, 0), Candidate;
+    vector<bool>    Sieve(SieveWindow);
+
+    // Keep picking random starting points until one has a prime after it...
+    while(!Stop.load(memory_order_relaxed))
+    {
+        // Draw an odd starting point with its top two bits set. With a single
+        //  bit in the top limb, the second lives in the one below...
+        bool Correction = false;
+        Generator.FillRandom64(&Start[0], Limbs, Correction);
+        CorrectionDetected |= Correction;
+        Start[Limbs - 1] &= TopMask;
+        if(TopBits == 1)
+        {
+            Start[Limbs - 1] |= 1;
+            Start[Limbs - 2] |= 1ULL << 63;
+        }
+        else
+            Start[Limbs - 1] |= TopTwo;
+        Start[0] |= 1;
+
+        // Strike out every odd offset where the candidate would be divisible
+        //  by a small prime. Offset j is candidate start + 2j, so it is
+        //  divisible by p when j is congruent to -start / 2 modulo p...
+        Sieve.assign(SieveWindow, false);
+        for(size_t Index = 0; Index < SmallPrimes.size(); ++Index)
+        {
+            const uint32_t Divisor  = SmallPrimes[Index];
+            const uint32_t Residue  = Remainder(Start, Divisor);
+            const uint64_t Half     = (Divisor + 1) / 2;
+            for(uint64_t Offset = ((Divisor - Residue) % Divisor) * Half % Divisor;
+                Offset < SieveWindow;
+                Offset += Divisor)
+                Sieve[Offset] = true;
+        }
+
+        // Test each survivor in turn...
+        for(size_t Offset = 0; Offset < SieveWindow; ++Offset)
+        {
+            // Sieved out...
+            if(Sieve[Offset])
+                continue;
+
+            // Someone else found one first...
+            if(Stop.load(memory_order_relaxed))
+                return false;
+
+            // Add the offset...
+            Candidate = Start;
+            Step[0] = 2 * Offset;
+            Add(&Candidate[0], &Step[0], Limbs);
+
+            // Carried into the top bits, so try somewhere else...
+            if(BigNumberBits(Candidate) != Bits ||
+               ((TopBits == 1) ? !(Candidate[Limbs - 2] >> 63)
+                               : ((Candidate[Limbs - 1] & TopTwo) != TopTwo)))
+                break;
+
+            // Found one...
+            if(IsProbablePrime(Generator, Candidate, CorrectionDetected))
+            {
+                Prime.swap(Candidate);
+                SecureWipe(&Start[0], Limbs * sizeof(uint64_t));
+                return true;
+            }
+        }
+    }
+
+    // Gave up...
+    SecureWipe(&Start[0], Limbs * sizeof(uint64_t));
+    return false;
+}
+
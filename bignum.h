@@ -0,0 +1,73 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Multiple include protection...
+#ifndef _BIG_NUMBER_H_
+#define _BIG_NUMBER_H_
+
+// Includes...
+
+    // Our headers...
+    #include "random.h"
+
+    // Standard C++...
+#ifdef __APPLE__
+    #include <tr1/cstdint>
+#else
+    #include <cstdint>
+#endif
+    #include <atomic>
+    #include <cstddef>
+    #include <vector>
+
+// Arbitrary precision unsigned integer as 64-bit limbs, least significant
+//  first, with no leading zero limbs...
+typedef std::vector<uint64_t> BigNumber;
+
+// Largest prime that can be requested, in bits...
+static const size_t MaximumPrimeBits = 16384;
+
+// Load a big endian byte string...
+void BigNumberFromBytes(
+    const uint8_t *Bytes, const size_t Count, BigNumber &Number);
+
+// Store as a big endian byte string of exactly the given length, which must
+//  be large enough...
+void BigNumberToBytes(
+    const BigNumber &Number, uint8_t *Bytes, const size_t Count);
+
+// Get the number of significant bits...
+size_t BigNumberBits(const BigNumber &Number);
+
+// Draw a number uniformly from [0, Bound), returning false if the bound is
+//  zero...
+bool RandomBelow(
+    RandomNumberGenerator  &Generator,
+    const BigNumber        &Bound,
+    BigNumber              &Result,
+    bool                   &CorrectionDetected);
+
+// Check if the given number is prime with Miller-Rabin, using OpenSSL's
+//  number of random bases for its size. From 100 bits up, a randomly chosen
+//  composite passes with probability below 2^-80. Below that only the worst
+//  case bound of 4^-rounds holds, which is below 2^-54...
+bool IsProbablePrime(
+    RandomNumberGenerator  &Generator,
+    const BigNumber        &Candidate,
+    bool                   &CorrectionDetected);
+
+// Search for a random prime of exactly the given number of bits, from 2 up to
+//  MaximumPrimeBits, with its two most significant bits set so that products
+//  of two such primes have exactly twice as many. Gives up and returns false
+//  if another searcher sets the given flag first...
+bool RandomPrime(
+    RandomNumberGenerator      &Generator,
+    const size_t                Bits,
+    const std::atomic<bool>    &Stop,
+    BigNumber                  &Prime,
+    bool                       &CorrectionDetected);
+
+#endif
+
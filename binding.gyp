@@ -3,13 +3,58 @@
     {
       "target_name": "rng",
       "sources": [
+        "arena.cpp",
+        "arena.h",
+        "bignum.cpp",
+        "bignum.h",
         "bindings.cpp",
         "bindings.h",
+        "bits.h",
+        "extractor.cpp",
+        "extractor.h",
+        "hardware.cpp",
+        "hardware.h",
+        "journal.cpp",
+        "journal.h",
+        "kernels.cpp",
+        "kernels.h",
         "node-rng.cpp",
         "node-rng.h",
+        "queue.cpp",
+        "queue.h",
         "random.cpp",
         "random.h",
-        "singleton.h"
+        "registry.h",
+        "singleton.h",
+        "siphash.h"
+      ]
+    },
+    {
+      "target_name": "rng_selftest",
+      "sources": [
+        "arena.cpp",
+        "arena.h",
+        "bignum.cpp",
+        "bignum.h",
+        "bits.h",
+        "extractor.cpp",
+        "extractor.h",
+        "hardware.cpp",
+        "hardware.h",
+        "journal.cpp",
+        "journal.h",
+        "kernels.cpp",
+        "kernels.h",
+        "node-rng-selftest.cpp",
+        "quality.cpp",
+        "quality.h",
+        "random.cpp",
+        "random.h",
+        "registry.h",
+        "selftest.cpp",
+        "selftest.h",
+        "singleton.h",
+        "siphash.h"
       ]
     }
   ]
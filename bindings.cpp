@@ -7,10 +7,16 @@
 
     // Our headers......
     #include "bindings.h"
+    #include "hardware.h"
+    #include "queue.h"
     #include "random.h"
 
+    // Node.js...
+    #include <node_buffer.h>
+
     // Standard C++...
     #include <cstdlib>
+    #include <cstring>
 
 // Import namespaces...
 
@@ -18,6 +24,8 @@
     using namespace std;
 
     // V8...
+    using v8::ArrayBuffer;
+    using v8::Boolean;
     using v8::Exception;
     using v8::Function;
     using v8::FunctionCallbackInfo;
@@ -27,8 +35,11 @@
     using v8::Integer;
     using v8::Isolate;
     using v8::Local;
+    using v8::Number;
     using v8::Object;
+    using v8::Persistent;
     using v8::String;
+    using v8::TypedArray;
     using v8::Uint32;
     using v8::Value;
 
@@ -36,20 +47,92 @@
 //  public interface...
 namespace rng
 {
-    // Thread implementing JavaScript's rng.getRandomAsync(
-    //  function(error, result)) and its corresponding completion function...
-    static void getRandomThread(uv_work_t *Request);
-    static void getRandomThreadComplete(uv_work_t *Request, int Status);
-
-    // Thread implementing JavaScript's rng.getRandomRangeAsync(lower, upper,
-    //  function(error, result)) and its corresponding completion function...
-    static void getRandomRangeThread(uv_work_t *Request);
-    static void getRandomRangeThreadComplete(uv_work_t *Request, int Status);
+    // Queue serving JavaScript's rng.getRandomAsync(function(error, result))
+    //  and rng.getRandomRangeAsync(lower, upper, function(error, result)),
+    //  created on first use...
+    static RequestQueue *RandomRequests = nullptr;
+
+    // Get the request queue, creating it if necessary...
+    static RequestQueue &GetRequestQueue();
+
+    // Invoke the callback of each request in a batch the queue completed...
+    static void DispatchRequests(
+        vector<RequestQueue::Request> &Completed, void *Data);
+
+    // Release the callback of a request the queue will never complete...
+    static void DiscardRequest(RequestQueue::Request &Dropped, void *Data);
+
+    // Thread implementing JavaScript's rng.fillRandomAsync(array,
+    //  function(error, array)) and its corresponding completion function...
+    static void fillRandomThread(uv_work_t *Request);
+    static void fillRandomThreadComplete(uv_work_t *Request, int);
+
+    // One of a few threads implementing JavaScript's
+    //  rng.getRandomPrimeAsync(bits, function(error, result)) and its
+    //  corresponding completion function...
+    static void getRandomPrimeThread(uv_work_t *Request);
+    static void getRandomPrimeThreadComplete(uv_work_t *Request, int);
+
+    // Get the number of threads in libuv's threadpool...
+    static size_t GetThreadpoolSize();
+
+    // Check if a draw was cut short by a journal being replayed running out
+    //  on a host without hardware, throwing a JavaScript exception if so...
+    static bool ThrowIfExhausted(
+        Isolate *isolate, const bool CorrectionDetected);
+
+    // Check that a number of bits for a prime was passed...
+    static bool ValidatePrimeBits(
+        Isolate *isolate, const FunctionCallbackInfo<Value> &Arguments);
+
+    // Get a pointer to the elements of the given typed array...
+    template <typename Element_t>
+    static Element_t *GetTypedArrayData(Local<Value> Array, size_t &Length);
+
+    // Names by which JavaScript selects each type of random number
+    //  generator...
+    static const struct
+    {
+        const char                         *Name;
+        RandomNumberGenerator::SourceType   Source;
+    }
+    SourceNames[] =
+    {
+        { "rdrand", RandomNumberGenerator::IntelSecureKey },
+        { "rdseed", RandomNumberGenerator::IntelSecureKeySeed },
+        { "mixed",  RandomNumberGenerator::Mixed }
+    };
 }
 
 // All methods exported, unless marked static, to the VM...
 namespace rng {
 
+// Callback implementing JavaScript rng.getCapabilities()...
+void getCapabilities(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Get what this host supports, probing it if nothing has yet...
+    const HostCapabilities &Capabilities = GetHostCapabilities();
+
+    // Pack into an object for the caller...
+    Local<Object> Result = Object::New(isolate);
+    Result->Set(String::NewFromUtf8(isolate, "rdrand"),
+        Boolean::New(isolate, Capabilities.RdRand));
+    Result->Set(String::NewFromUtf8(isolate, "rdseed"),
+        Boolean::New(isolate, Capabilities.RdSeed));
+    Result->Set(String::NewFromUtf8(isolate, "aesni"),
+        Boolean::New(isolate, Capabilities.AesNi));
+    Result->Set(String::NewFromUtf8(isolate, "avx2"),
+        Boolean::New(isolate, Capabilities.Avx2));
+    Result->Set(String::NewFromUtf8(isolate, "avx512"),
+        Boolean::New(isolate, Capabilities.Avx512));
+
+    // Done...
+    Arguments.GetReturnValue().Set(Result);
+}
+
 // Callback implementing JavaScript rng.getCorrections()...
 void getCorrections(const FunctionCallbackInfo<Value> &Arguments)
 {
@@ -97,87 +180,55 @@ void getRandomAsync(const FunctionCallbackInfo<Value> &Arguments)
             return;
         }
 
-    // Prepare and initialize the work object to store inputs and outputs of
-    //  this call on the heap...
-    Work<uint32_t> *work = new Work<uint32_t>();
-    work->Request.data = work;
-
-    // Remember the location of the callback that was provided in the VM...
-    Local<Function> callback = Local<Function>::Cast(Arguments[0]);
-    work->Callback.Reset(isolate, callback);
-
-    // Initiate worker thread...
-    uv_queue_work(
-        uv_default_loop(),
-       &work->Request,
-        rng::getRandomThread,
-        rng::getRandomThreadComplete);
+    // Queue the draw, holding onto the callback until it is dispatched...
+    RequestQueue::Request Queued;
+    Queued.Context = new Persistent<Function>(
+        isolate, Local<Function>::Cast(Arguments[0]));
+    GetRequestQueue().Push(Queued);
 
     // Caller should not expect anything returned when invoked asynchronously...
     Arguments.GetReturnValue().Set(Undefined(isolate));
 }
 
-// Thread implementing JavaScript's rng.getRandomAsync(function(result))...
-static void getRandomThread(uv_work_t *Request)
-{
-    // Retrieve the work object from the heap...
-    Work<uint32_t> *work = static_cast<Work<uint32_t> *>(Request->data);
-
-    // Get the actual random number...
-    const uint32_t Random =
-        RandomNumberGenerator::GetInstance().GetRandom32(work->CorrectionDetected);
-
-    // Store result for user's callback...
-    work->Result = Random;
-}
-
-// Callback invoked upon getRandomThread completing execution...
-static void getRandomThreadComplete(uv_work_t *Request, int Status)
+// Callback implementing JavaScript rng.getRandom()...
+void getRandom(const FunctionCallbackInfo<Value> &Arguments)
 {
     // Retrieve virtual machine state...
-    Isolate *isolate = Isolate::GetCurrent();
-
-    // This is required for Node 4.x...
-    HandleScope handleScope(isolate);
-
-    // Retrieve the work object from the heap...
-    Work<uint32_t> *work = static_cast<Work<uint32_t> *>(Request->data);
+    Isolate *isolate = Arguments.GetIsolate();
 
-    // Store the result for the caller's callback...
+    // Get the random number generator...
+    RandomNumberGenerator &Generator = RandomNumberGenerator::GetInstance();
 
-        // Storage for arguments into callback...
-        Handle<Value> CallbackArguments[2];
+    // Random number generator is not available...
+    if(!Generator.IsAvailable())
+    {
+        // Throw a JavaScript exception within the virtual machine...
+        isolate->ThrowException(
+            Exception::TypeError(String::NewFromUtf8(
+                isolate, "random number generator is not available")));
+        return;
+    }
 
-        // Error...
-        if(work->CorrectionDetected)
-            CallbackArguments[0] = Exception::Error(
-                String::NewFromUtf8(isolate, "RNG correction detected"));
-        else
-            CallbackArguments[0] = Null(isolate);
-        
-        // Result...
-        CallbackArguments[1] = Int32::New(isolate, work->Result);
+    // Pass random number back to caller...
+    bool CorrectionDetected = false;
+    const uint32_t Random = Generator.GetRandom32(CorrectionDetected);
 
-    // Execute the caller's callback...
-    Local<Function>::New(isolate, work->Callback)->
-        Call(isolate->GetCurrentContext()->Global(), 2, CallbackArguments);
+    // Journal being replayed ran out part way through...
+    if(ThrowIfExhausted(isolate, CorrectionDetected))
+        return;
 
-    // Cleanup persistent function callback and the worker bookkeeping memory...
-    work->Callback.Reset();
-    delete work;
+    // Pass back to caller...
+    Arguments.GetReturnValue().Set(Random);
 }
 
-// Callback implementing JavaScript rng.getRandom()...
-void getRandom(const FunctionCallbackInfo<Value> &Arguments)
+// Callback implementing JavaScript rng.getRandomBelow(bound)...
+void getRandomBelow(const FunctionCallbackInfo<Value> &Arguments)
 {
     // Retrieve virtual machine state...
     Isolate *isolate = Arguments.GetIsolate();
 
-    // Get the random number generator...
-    RandomNumberGenerator &Generator = RandomNumberGenerator::GetInstance();
-
     // Random number generator is not available...
-    if(!Generator.IsAvailable())
+    if(!RandomNumberGenerator::GetInstance().IsAvailable())
     {
         // Throw a JavaScript exception within the virtual machine...
         isolate->ThrowException(
@@ -186,14 +237,64 @@ void getRandom(const FunctionCallbackInfo<Value> &Arguments)
         return;
     }
 
-    // Pass random number back to caller...
+    // Validate arguments...
+
+        // Insufficient in number...
+        if(Arguments.Length() != 1)
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected one argument")));
+            return;
+        }
+
+        // Incorrect type...
+        if(!node::Buffer::HasInstance(Arguments[0]))
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected a big endian Buffer")));
+            return;
+        }
+
+        // Get arguments...
+        const size_t Bytes = node::Buffer::Length(Arguments[0]);
+        BigNumber Bound;
+        BigNumberFromBytes(
+            reinterpret_cast<const uint8_t *>(node::Buffer::Data(Arguments[0])),
+            Bytes,
+            Bound);
+
+    // Draw...
+    BigNumber Number;
     bool CorrectionDetected = false;
-    Arguments.GetReturnValue().Set(Generator.GetRandom32(CorrectionDetected));
+    if(!RandomBelow(
+        RandomNumberGenerator::GetInstance(), Bound, Number, CorrectionDetected))
+    {
+        // Throw a JavaScript exception within the virtual machine...
+        isolate->ThrowException(Exception::RangeError(
+        String::NewFromUtf8(isolate, "expected a bound above zero")));
+        return;
+    }
+
+    // Store as long as the bound...
+    Local<Object> Result = node::Buffer::New(isolate, Bytes).ToLocalChecked();
+    BigNumberToBytes(
+        Number, reinterpret_cast<uint8_t *>(node::Buffer::Data(Result)), Bytes);
+    if(!Number.empty())
+        SecureWipe(&Number[0], Number.size() * sizeof(uint64_t));
+
+    // Journal being replayed ran out part way through...
+    if(ThrowIfExhausted(isolate, CorrectionDetected))
+        return;
+
+    // Pass back to caller...
+    Arguments.GetReturnValue().Set(Result);
 }
 
-// Callback implementing JavaScript rng.getRandomRangeAsync(lower, upper,
-//  function(error, result))...
-void getRandomRangeAsync(const FunctionCallbackInfo<Value> &Arguments)
+// Callback implementing JavaScript rng.getRandomBits(bits), also exported as
+//  rng.randomBits(bits)...
+void getRandomBits(const FunctionCallbackInfo<Value> &Arguments)
 {
     // Retrieve virtual machine state...
     Isolate *isolate = Arguments.GetIsolate();
@@ -211,116 +312,272 @@ void getRandomRangeAsync(const FunctionCallbackInfo<Value> &Arguments)
     // Validate arguments...
 
         // Insufficient in number...
-        if(Arguments.Length() != 3)
+        if(Arguments.Length() != 1)
         {
             // Throw a JavaScript exception within the virtual machine...
             isolate->ThrowException(Exception::TypeError(
-            String::NewFromUtf8(isolate, "expected three arguments")));
+            String::NewFromUtf8(isolate, "expected one argument")));
             return;
         }
 
         // Incorrect type...
-        if(!Arguments[0]->IsInt32() || !Arguments[1]->IsInt32() || !Arguments[2]->IsFunction())
+        if(!Arguments[0]->IsUint32())
         {
             // Throw a JavaScript exception within the virtual machine...
             isolate->ThrowException(Exception::TypeError(
-            String::NewFromUtf8(isolate, "expected two integers and a function")));
+            String::NewFromUtf8(isolate, "expected an unsigned integer")));
             return;
         }
 
         // Get arguments...
-        const int32_t Lower = Arguments[0]->ToInt32()->Value();
-        const int32_t Upper = Arguments[1]->ToInt32()->Value();
+        const uint32_t Bits = Arguments[0]->ToUint32()->Value();
 
-        // Invalid values...
-        if(Lower >= Upper)
+    // Allocate a buffer just large enough...
+    Local<Object> Result =
+        node::Buffer::New(isolate, (Bits + 7) / 8).ToLocalChecked();
+
+    // Fill it...
+    bool CorrectionDetected = false;
+    RandomNumberGenerator::GetInstance().FillRandomBits(
+        reinterpret_cast<uint8_t *>(node::Buffer::Data(Result)),
+        Bits,
+        CorrectionDetected);
+
+    // Journal being replayed ran out part way through...
+    if(ThrowIfExhausted(isolate, CorrectionDetected))
+        return;
+
+    // Pass back to caller...
+    Arguments.GetReturnValue().Set(Result);
+}
+
+// Callback implementing JavaScript rng.getRandomPrime(bits)...
+void getRandomPrime(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Validate arguments...
+    if(!ValidatePrimeBits(isolate, Arguments))
+        return;
+    const uint32_t Bits = Arguments[0]->ToUint32()->Value();
+
+    // Search on this thread alone...
+    BigNumber Prime;
+    bool CorrectionDetected = false;
+    const std::atomic<bool> Stop(false);
+    RandomPrime(
+        RandomNumberGenerator::GetInstance(), Bits, Stop, Prime, CorrectionDetected);
+
+    // Store...
+    const size_t Bytes = (Bits + 7) / 8;
+    Local<Object> Result = node::Buffer::New(isolate, Bytes).ToLocalChecked();
+    BigNumberToBytes(
+        Prime, reinterpret_cast<uint8_t *>(node::Buffer::Data(Result)), Bytes);
+    if(!Prime.empty())
+        SecureWipe(&Prime[0], Prime.size() * sizeof(uint64_t));
+
+    // Journal being replayed ran out part way through...
+    if(ThrowIfExhausted(isolate, CorrectionDetected))
+        return;
+
+    // Pass back to caller...
+    Arguments.GetReturnValue().Set(Result);
+}
+
+// Callback implementing JavaScript rng.getRandomPrimeAsync(bits,
+//  function(error, result))...
+void getRandomPrimeAsync(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Validate arguments...
+
+        // Number of bits...
+        if(!ValidatePrimeBits(isolate, Arguments))
+            return;
+
+        // Incorrect type...
+        if(Arguments.Length() != 2 || !Arguments[1]->IsFunction())
         {
             // Throw a JavaScript exception within the virtual machine...
             isolate->ThrowException(Exception::TypeError(
-            String::NewFromUtf8(isolate, "first argument must be less than second")));
+            String::NewFromUtf8(isolate, "expected a number of bits and a function")));
             return;
         }
 
     // Prepare and initialize the work object to store inputs and outputs of
     //  this call on the heap...
-    Work<int32_t> *work = new Work<int32_t>();
-    work->Request.data = work;
-
-    // Load the work object with the caller's inputs and outputs...
-    work->Lower = Lower;
-    work->Upper = Upper;
+    PrimeWork *work = new PrimeWork();
+    work->Bits = Arguments[0]->ToUint32()->Value();
 
     // Remember the location of the callback that was provided in the VM...
-    Local<Function> callback = Local<Function>::Cast(Arguments[2]);
+    Local<Function> callback = Local<Function>::Cast(Arguments[1]);
     work->Callback.Reset(isolate, callback);
 
-    // Initiate worker thread...
-    uv_queue_work(
-        uv_default_loop(),
-       &work->Request,
-        rng::getRandomRangeThread,
-        rng::getRandomRangeThreadComplete);
+    // Race workers on half the threads in the pool, leaving the rest for
+    //  whatever else is queued. Candidates are independent, so the first
+    //  prime any of them finds is as good as any other...
+    work->Remaining = max<size_t>(GetThreadpoolSize() / 2, 1);
+    work->Requests.resize(work->Remaining);
+    for(size_t Index = 0; Index < work->Requests.size(); ++Index)
+    {
+        work->Requests[Index].data = work;
+        uv_queue_work(
+            uv_default_loop(),
+           &work->Requests[Index],
+            rng::getRandomPrimeThread,
+            rng::getRandomPrimeThreadComplete);
+    }
 
     // Caller should not expect anything returned when invoked asynchronously...
     Arguments.GetReturnValue().Set(Undefined(isolate));
 }
 
-// Thread implementing JavaScript's rng.getRandomRangeAsync(lower, upper,
-//  function(error, result))...
-static void getRandomRangeThread(uv_work_t *Request)
+// One of several threads implementing JavaScript's
+//  rng.getRandomPrimeAsync(bits, function(error, result))...
+static void getRandomPrimeThread(uv_work_t *Request)
 {
     // Retrieve the work object from the heap...
-    Work<int32_t> *work = static_cast<Work<int32_t> *>(Request->data);
-
-    // Get arguments...
-    const int32_t Lower = work->Lower;
-    const int32_t Upper = work->Upper;
-
-    // Get the actual random number...
-    const int32_t Random =
-        RandomNumberGenerator::GetInstance().GetRandomRange32(
-            Lower, Upper, work->CorrectionDetected);
+    PrimeWork *work = static_cast<PrimeWork *>(Request->data);
 
-    // Store result for user's callback...
-    work->Result = Random;
+    // Search until we or another worker find one...
+    BigNumber Prime;
+    bool CorrectionDetected = false;
+    const bool Found = RandomPrime(
+        RandomNumberGenerator::GetInstance(),
+        work->Bits,
+        work->Found,
+        Prime,
+        CorrectionDetected);
+
+    // Remember any correction...
+    if(CorrectionDetected)
+        work->CorrectionDetected.store(true, memory_order_relaxed);
+
+    // Only the first to find one gets to store it...
+    bool Expected = false;
+    if(Found && work->Found.compare_exchange_strong(Expected, true))
+        work->Prime.swap(Prime);
+
+    // Otherwise wipe ours...
+    else if(!Prime.empty())
+        SecureWipe(&Prime[0], Prime.size() * sizeof(uint64_t));
 }
 
-// Callback invoked upon getRandomThread completing execution...
-static void getRandomRangeThreadComplete(uv_work_t *Request, int Status)
+// Callback invoked upon each getRandomPrimeThread completing execution...
+static void getRandomPrimeThreadComplete(uv_work_t *Request, int)
 {
+    // Retrieve the work object from the heap...
+    PrimeWork *work = static_cast<PrimeWork *>(Request->data);
+
+    // Wait for every worker, so none is left using the work object...
+    if(--work->Remaining)
+        return;
+
     // Retrieve virtual machine state...
     Isolate *isolate = Isolate::GetCurrent();
 
     // This is required for Node 4.x...
     HandleScope handleScope(isolate);
 
-    // Retrieve the work object from the heap...
-    Work<int32_t> *work = static_cast<Work<int32_t> *>(Request->data);
-
     // Store the result for the caller's callback...
 
         // Storage for arguments into callback...
         Handle<Value> CallbackArguments[2];
 
         // Error...
-        if(work->CorrectionDetected)
+        if(work->CorrectionDetected.load(memory_order_relaxed))
             CallbackArguments[0] = Exception::Error(
                 String::NewFromUtf8(isolate, "RNG correction detected"));
         else
             CallbackArguments[0] = Null(isolate);
-        
+
         // Result...
-        CallbackArguments[1] = Int32::New(isolate, work->Result);
+        const size_t Bytes = (work->Bits + 7) / 8;
+        Local<Object> Result =
+            node::Buffer::New(isolate, Bytes).ToLocalChecked();
+        BigNumberToBytes(
+            work->Prime,
+            reinterpret_cast<uint8_t *>(node::Buffer::Data(Result)),
+            Bytes);
+        CallbackArguments[1] = Result;
 
     // Execute the caller's callback...
     Local<Function>::New(isolate, work->Callback)->
         Call(isolate->GetCurrentContext()->Global(), 2, CallbackArguments);
 
     // Cleanup persistent function callback and the worker bookkeeping memory...
+    if(!work->Prime.empty())
+        SecureWipe(&work->Prime[0], work->Prime.size() * sizeof(uint64_t));
     work->Callback.Reset();
     delete work;
 }
 
+// Callback implementing JavaScript rng.getRandomRangeAsync(lower, upper,
+//  function(error, result))...
+void getRandomRangeAsync(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Random number generator is not available...
+    if(!RandomNumberGenerator::GetInstance().IsAvailable())
+    {
+        // Throw a JavaScript exception within the virtual machine...
+        isolate->ThrowException(
+            Exception::TypeError(String::NewFromUtf8(
+                isolate, "random number generator is not available")));
+        return;
+    }
+
+    // Validate arguments...
+
+        // Insufficient in number...
+        if(Arguments.Length() != 3)
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected three arguments")));
+            return;
+        }
+
+        // Incorrect type...
+        if(!Arguments[0]->IsInt32() || !Arguments[1]->IsInt32() || !Arguments[2]->IsFunction())
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected two integers and a function")));
+            return;
+        }
+
+        // Get arguments...
+        const int32_t Lower = Arguments[0]->ToInt32()->Value();
+        const int32_t Upper = Arguments[1]->ToInt32()->Value();
+
+        // Invalid values...
+        if(Lower >= Upper)
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "first argument must be less than second")));
+            return;
+        }
+
+    // Queue the draw, holding onto the callback until it is dispatched...
+    RequestQueue::Request Queued;
+    Queued.Ranged   = true;
+    Queued.Lower    = Lower;
+    Queued.Upper    = Upper;
+    Queued.Context  = new Persistent<Function>(
+        isolate, Local<Function>::Cast(Arguments[2]));
+    GetRequestQueue().Push(Queued);
+
+    // Caller should not expect anything returned when invoked asynchronously...
+    Arguments.GetReturnValue().Set(Undefined(isolate));
+}
+
 // Callback implementing JavaScript rng.getRandom(lower, upper)...
 void getRandomRange(const FunctionCallbackInfo<Value> &Arguments)
 {
@@ -375,31 +632,753 @@ void getRandomRange(const FunctionCallbackInfo<Value> &Arguments)
 
     // Pass random number back to caller...
     bool CorrectionDetected = false;
-    Arguments.GetReturnValue().Set(Generator.GetRandomRange32(
-        Lower, Upper, CorrectionDetected));
+    const int32_t Random =
+        Generator.GetRandomRange32(Lower, Upper, CorrectionDetected);
+
+    // Journal being replayed ran out part way through...
+    if(ThrowIfExhausted(isolate, CorrectionDetected))
+        return;
+
+    // Pass back to caller...
+    Arguments.GetReturnValue().Set(Random);
 }
 
-// Callback implementing JavaScript rng.getVersion()...
-void getVersion(const FunctionCallbackInfo<Value> &Arguments)
+// Callback implementing JavaScript rng.fillBernoulli(array, probability)...
+void fillBernoulli(const FunctionCallbackInfo<Value> &Arguments)
 {
     // Retrieve virtual machine state...
     Isolate *isolate = Arguments.GetIsolate();
 
-    // Prepare the version as the return value...
-    Local<String> ReturnValue =
-        String::NewFromUtf8(isolate, NODE_RNG_VERSION_STRING);
+    // Random number generator is not available...
+    if(!RandomNumberGenerator::GetInstance().IsAvailable())
+    {
+        // Throw a JavaScript exception within the virtual machine...
+        isolate->ThrowException(
+            Exception::TypeError(String::NewFromUtf8(
+                isolate, "random number generator is not available")));
+        return;
+    }
 
-    Arguments.GetReturnValue().Set(ReturnValue);
-}
+    // Validate arguments...
 
-// Callback implementing JavaScript rng.isAvailable()...
-void isAvailable(const FunctionCallbackInfo<Value> &Arguments)
-{
-    // Get the random number generator...
-    const RandomNumberGenerator &Generator = RandomNumberGenerator::GetInstance();
+        // Insufficient in number...
+        if(Arguments.Length() != 2)
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected two arguments")));
+            return;
+        }
 
-    // Query it's availability and return to JavaScript caller...
+        // Incorrect type...
+        if(!Arguments[0]->IsUint8Array() || !Arguments[1]->IsNumber())
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected a Uint8Array and a number")));
+            return;
+        }
+
+        // Get arguments...
+        size_t Length = 0;
+        uint8_t *Output = GetTypedArrayData<uint8_t>(Arguments[0], Length);
+        const double Probability = Arguments[1]->NumberValue();
+
+        // Invalid values...
+        if(!(Probability >= 0.0 && Probability <= 1.0))
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "probability must be within [0, 1]")));
+            return;
+        }
+
+    // Fill it...
+    bool CorrectionDetected = false;
+    RandomNumberGenerator::GetInstance().FillBernoulli(
+        Output, Length, Probability, CorrectionDetected);
+
+    // Journal being replayed ran out part way through...
+    if(ThrowIfExhausted(isolate, CorrectionDetected))
+        return;
+
+    // Pass the array back to caller for convenience...
+    Arguments.GetReturnValue().Set(Arguments[0]);
+}
+
+// Callback implementing JavaScript rng.fillRandom(array)...
+void fillRandom(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Random number generator is not available...
+    if(!RandomNumberGenerator::GetInstance().IsAvailable())
+    {
+        // Throw a JavaScript exception within the virtual machine...
+        isolate->ThrowException(
+            Exception::TypeError(String::NewFromUtf8(
+                isolate, "random number generator is not available")));
+        return;
+    }
+
+    // Validate arguments...
+
+        // Insufficient in number...
+        if(Arguments.Length() != 1)
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected one argument")));
+            return;
+        }
+
+        // Incorrect type...
+        if(!Arguments[0]->IsUint32Array())
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected a Uint32Array")));
+            return;
+        }
+
+        // Get arguments...
+        size_t Length = 0;
+        uint32_t *Words = GetTypedArrayData<uint32_t>(Arguments[0], Length);
+
+    // Fill it...
+    bool CorrectionDetected = false;
+    RandomNumberGenerator::GetInstance().FillRandom32(
+        Words, Length, CorrectionDetected);
+
+    // Journal being replayed ran out part way through...
+    if(ThrowIfExhausted(isolate, CorrectionDetected))
+        return;
+
+    // Pass the array back to caller for convenience...
+    Arguments.GetReturnValue().Set(Arguments[0]);
+}
+
+// Callback implementing JavaScript rng.fillRandomAsync(array,
+//  function(error, array))...
+void fillRandomAsync(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Random number generator is not available...
+    if(!RandomNumberGenerator::GetInstance().IsAvailable())
+    {
+        // Throw a JavaScript exception within the virtual machine...
+        isolate->ThrowException(
+            Exception::TypeError(String::NewFromUtf8(
+                isolate, "random number generator is not available")));
+        return;
+    }
+
+    // Validate arguments...
+
+        // Insufficient in number...
+        if(Arguments.Length() != 2)
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected two arguments")));
+            return;
+        }
+
+        // Incorrect type...
+        if(!Arguments[0]->IsUint32Array() || !Arguments[1]->IsFunction())
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected a Uint32Array and a function")));
+            return;
+        }
+
+    // Prepare and initialize the work object to store inputs and outputs of
+    //  this call on the heap...
+    FillWork *work = new FillWork();
+    work->Request.data = work;
+
+    // Locate the array's elements and hold onto it until we are done...
+    work->Words = GetTypedArrayData<uint32_t>(Arguments[0], work->Length);
+    work->Array.Reset(isolate, Local<Object>::Cast(Arguments[0]));
+
+    // Remember the location of the callback that was provided in the VM...
+    Local<Function> callback = Local<Function>::Cast(Arguments[1]);
+    work->Callback.Reset(isolate, callback);
+
+    // Initiate worker thread...
+    uv_queue_work(
+        uv_default_loop(),
+       &work->Request,
+        rng::fillRandomThread,
+        rng::fillRandomThreadComplete);
+
+    // Caller should not expect anything returned when invoked asynchronously...
+    Arguments.GetReturnValue().Set(Undefined(isolate));
+}
+
+// Thread implementing JavaScript's rng.fillRandomAsync(array,
+//  function(error, array))...
+static void fillRandomThread(uv_work_t *Request)
+{
+    // Retrieve the work object from the heap...
+    FillWork *work = static_cast<FillWork *>(Request->data);
+
+    // Fill the caller's array...
+    RandomNumberGenerator::GetInstance().FillRandom32(
+        work->Words, work->Length, work->CorrectionDetected);
+}
+
+// Callback invoked upon fillRandomThread completing execution...
+static void fillRandomThreadComplete(uv_work_t *Request, int)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Isolate::GetCurrent();
+
+    // This is required for Node 4.x...
+    HandleScope handleScope(isolate);
+
+    // Retrieve the work object from the heap...
+    FillWork *work = static_cast<FillWork *>(Request->data);
+
+    // Store the result for the caller's callback...
+
+        // Storage for arguments into callback...
+        Handle<Value> CallbackArguments[2];
+
+        // Error...
+        if(work->CorrectionDetected)
+            CallbackArguments[0] = Exception::Error(
+                String::NewFromUtf8(isolate, "RNG correction detected"));
+        else
+            CallbackArguments[0] = Null(isolate);
+
+        // Result...
+        CallbackArguments[1] = Local<Object>::New(isolate, work->Array);
+
+    // Execute the caller's callback...
+    Local<Function>::New(isolate, work->Callback)->
+        Call(isolate->GetCurrentContext()->Global(), 2, CallbackArguments);
+
+    // Cleanup persistent handles and the worker bookkeeping memory...
+    work->Callback.Reset();
+    work->Array.Reset();
+    delete work;
+}
+
+// Callback implementing JavaScript rng.fillRandomFloat(array)...
+void fillRandomFloat(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Random number generator is not available...
+    if(!RandomNumberGenerator::GetInstance().IsAvailable())
+    {
+        // Throw a JavaScript exception within the virtual machine...
+        isolate->ThrowException(
+            Exception::TypeError(String::NewFromUtf8(
+                isolate, "random number generator is not available")));
+        return;
+    }
+
+    // Validate arguments...
+
+        // Insufficient in number...
+        if(Arguments.Length() != 1)
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected one argument")));
+            return;
+        }
+
+        // Incorrect type...
+        if(!Arguments[0]->IsFloat64Array())
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected a Float64Array")));
+            return;
+        }
+
+        // Get arguments...
+        size_t Length = 0;
+        double *Output = GetTypedArrayData<double>(Arguments[0], Length);
+
+    // Fill it...
+    bool CorrectionDetected = false;
+    RandomNumberGenerator::GetInstance().FillRandomDouble(
+        Output, Length, CorrectionDetected);
+
+    // Journal being replayed ran out part way through...
+    if(ThrowIfExhausted(isolate, CorrectionDetected))
+        return;
+
+    // Pass the array back to caller for convenience...
+    Arguments.GetReturnValue().Set(Arguments[0]);
+}
+
+// Callback implementing JavaScript rng.fillRandomRange(array, lower, upper)...
+void fillRandomRange(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Random number generator is not available...
+    if(!RandomNumberGenerator::GetInstance().IsAvailable())
+    {
+        // Throw a JavaScript exception within the virtual machine...
+        isolate->ThrowException(
+            Exception::TypeError(String::NewFromUtf8(
+                isolate, "random number generator is not available")));
+        return;
+    }
+
+    // Validate arguments...
+
+        // Insufficient in number...
+        if(Arguments.Length() != 3)
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected three arguments")));
+            return;
+        }
+
+        // Incorrect type...
+        if(!Arguments[0]->IsInt32Array() || !Arguments[1]->IsInt32() || !Arguments[2]->IsInt32())
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected an Int32Array and two integers")));
+            return;
+        }
+
+        // Get arguments...
+        size_t Length = 0;
+        int32_t *Output = GetTypedArrayData<int32_t>(Arguments[0], Length);
+        const int32_t Lower = Arguments[1]->ToInt32()->Value();
+        const int32_t Upper = Arguments[2]->ToInt32()->Value();
+
+        // Invalid values...
+        if(Lower >= Upper)
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "second argument must be less than third")));
+            return;
+        }
+
+    // Fill it...
+    bool CorrectionDetected = false;
+    RandomNumberGenerator::GetInstance().FillRandomRange32(
+        Output, Length, Lower, Upper, CorrectionDetected);
+
+    // Journal being replayed ran out part way through...
+    if(ThrowIfExhausted(isolate, CorrectionDetected))
+        return;
+
+    // Pass the array back to caller for convenience...
+    Arguments.GetReturnValue().Set(Arguments[0]);
+}
+
+// Callback implementing JavaScript rng.getKernels()...
+void getKernels(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Name the instruction set the bulk kernels were selected for...
+    Arguments.GetReturnValue().Set(String::NewFromUtf8(
+        isolate, RandomNumberGenerator::GetInstance().GetKernels().Name));
+}
+
+// Callback implementing JavaScript rng.getSource()...
+void getSource(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Get the type of random number generator in use...
+    const RandomNumberGenerator::SourceType Source =
+        RandomNumberGenerator::GetInstance().GetSource();
+
+    // Find its name...
+    for(size_t Index = 0; Index < sizeof(SourceNames) / sizeof(SourceNames[0]); ++Index)
+    {
+        if(SourceNames[Index].Source == Source)
+        {
+            Arguments.GetReturnValue().Set(
+                String::NewFromUtf8(isolate, SourceNames[Index].Name));
+            return;
+        }
+    }
+
+    // None available...
+    Arguments.GetReturnValue().Set(Null(isolate));
+}
+
+// Callback implementing JavaScript rng.getSourceStatistics()...
+void getSourceStatistics(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Get how much each source has contributed to the mixed source...
+    RandomNumberGenerator &Generator = RandomNumberGenerator::GetInstance();
+    const EntropyExtractor::Statistics Statistics =
+        Generator.GetSourceStatistics();
+
+    // Pack into an object for the caller...
+    Local<Object> Result = Object::New(isolate);
+    Result->Set(String::NewFromUtf8(isolate, "rdrandWords"),
+        Number::New(isolate, static_cast<double>(Statistics.RdRandWords)));
+    Result->Set(String::NewFromUtf8(isolate, "rdseedWords"),
+        Number::New(isolate, static_cast<double>(Statistics.RdSeedWords)));
+    Result->Set(String::NewFromUtf8(isolate, "rdseedFailures"),
+        Number::New(isolate, static_cast<double>(Statistics.RdSeedFailures)));
+    Result->Set(String::NewFromUtf8(isolate, "systemBytes"),
+        Number::New(isolate, static_cast<double>(Statistics.SystemBytes)));
+    Result->Set(String::NewFromUtf8(isolate, "blocks"),
+        Number::New(isolate, static_cast<double>(Statistics.Blocks)));
+    Result->Set(String::NewFromUtf8(isolate, "locked"),
+        Boolean::New(isolate, Generator.IsMemoryLocked()));
+
+    // Pass back to caller...
+    Arguments.GetReturnValue().Set(Result);
+}
+
+// Callback implementing JavaScript rng.getVersion()...
+void getVersion(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Prepare the version as the return value...
+    Local<String> ReturnValue =
+        String::NewFromUtf8(isolate, NODE_RNG_VERSION_STRING);
+
+    Arguments.GetReturnValue().Set(ReturnValue);
+}
+
+// Callback implementing JavaScript rng.isAvailable()...
+void isAvailable(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Get the random number generator...
+    const RandomNumberGenerator &Generator = RandomNumberGenerator::GetInstance();
+
+    // Query it's availability and return to JavaScript caller...
     Arguments.GetReturnValue().Set(Generator.IsAvailable());
 }
 
+// Callback implementing JavaScript rng.recordJournal(path)...
+void recordJournal(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Validate arguments...
+
+        // Insufficient in number...
+        if(Arguments.Length() != 1)
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected one argument")));
+            return;
+        }
+
+        // Incorrect type...
+        if(!Arguments[0]->IsString())
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected a path string")));
+            return;
+        }
+
+        // Get arguments...
+        const String::Utf8Value Path(Arguments[0]);
+
+    // Start recording...
+    if(!RandomNumberGenerator::GetInstance().StartRecording(*Path))
+    {
+        // Throw a JavaScript exception within the virtual machine...
+        isolate->ThrowException(Exception::Error(
+        String::NewFromUtf8(isolate, "unable to create journal")));
+        return;
+    }
+
+    // Nothing to return...
+    Arguments.GetReturnValue().Set(Undefined(isolate));
+}
+
+// Callback implementing JavaScript rng.replayJournal(path)...
+void replayJournal(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Validate arguments...
+
+        // Insufficient in number...
+        if(Arguments.Length() != 1)
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected one argument")));
+            return;
+        }
+
+        // Incorrect type...
+        if(!Arguments[0]->IsString())
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected a path string")));
+            return;
+        }
+
+        // Get arguments...
+        const String::Utf8Value Path(Arguments[0]);
+
+    // Start replaying...
+    if(!RandomNumberGenerator::GetInstance().StartReplaying(*Path))
+    {
+        // Throw a JavaScript exception within the virtual machine...
+        isolate->ThrowException(Exception::Error(
+        String::NewFromUtf8(isolate, "unable to open journal")));
+        return;
+    }
+
+    // Nothing to return...
+    Arguments.GetReturnValue().Set(Undefined(isolate));
+}
+
+// Callback implementing JavaScript rng.setSource(name)...
+void setSource(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Validate arguments...
+
+        // Insufficient in number...
+        if(Arguments.Length() != 1)
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected one argument")));
+            return;
+        }
+
+        // Incorrect type...
+        if(!Arguments[0]->IsString())
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected a source name")));
+            return;
+        }
+
+        // Get arguments...
+        const String::Utf8Value Name(Arguments[0]);
+
+    // Find the named source...
+    for(size_t Index = 0; Index < sizeof(SourceNames) / sizeof(SourceNames[0]); ++Index)
+    {
+        // Not this one...
+        if(::strcmp(SourceNames[Index].Name, *Name) != 0)
+            continue;
+
+        // Switch to it...
+        if(!RandomNumberGenerator::GetInstance().SetSource(
+            SourceNames[Index].Source))
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::Error(
+            String::NewFromUtf8(isolate, "source is not supported by this host")));
+            return;
+        }
+
+        // Nothing to return...
+        Arguments.GetReturnValue().Set(Undefined(isolate));
+        return;
+    }
+
+    // Unknown...
+    isolate->ThrowException(Exception::TypeError(
+    String::NewFromUtf8(isolate, "unknown source name")));
+}
+
+// Callback implementing JavaScript rng.stopJournal()...
+void stopJournal(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Close the journal and pass back how many words it held...
+    const uint64_t Words = RandomNumberGenerator::GetInstance().StopJournal();
+    Arguments.GetReturnValue().Set(
+        Number::New(isolate, static_cast<double>(Words)));
+}
+
+// Get the request queue, creating it if necessary...
+static RequestQueue &GetRequestQueue()
+{
+    // First asynchronous draw...
+    if(!RandomRequests)
+        RandomRequests = new RequestQueue(
+            uv_default_loop(),
+            RandomNumberGenerator::GetInstance(),
+            DispatchRequests,
+            DiscardRequest,
+            nullptr);
+
+    // Done...
+    return *RandomRequests;
+}
+
+// Invoke the callback of each request in a batch the queue completed...
+static void DispatchRequests(vector<RequestQueue::Request> &Completed, void *)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Isolate::GetCurrent();
+
+    // One scope for the whole batch...
+    HandleScope handleScope(isolate);
+
+    // Dispatch each in the order they were queued...
+    for(size_t Index = 0; Index < Completed.size(); ++Index)
+    {
+        // The request and its callback...
+        const RequestQueue::Request &Completion = Completed[Index];
+        Persistent<Function> *Callback =
+            static_cast<Persistent<Function> *>(Completion.Context);
+
+        // Storage for arguments into callback...
+        Handle<Value> CallbackArguments[2];
+
+        // Error...
+        if(Completion.CorrectionDetected)
+            CallbackArguments[0] = Exception::Error(
+                String::NewFromUtf8(isolate, "RNG correction detected"));
+        else
+            CallbackArguments[0] = Null(isolate);
+
+        // Result...
+        CallbackArguments[1] =
+            Int32::New(isolate, static_cast<int32_t>(Completion.Result));
+
+        // Execute the caller's callback...
+        Local<Function>::New(isolate, *Callback)->
+            Call(isolate->GetCurrentContext()->Global(), 2, CallbackArguments);
+
+        // Cleanup persistent function callback...
+        Callback->Reset();
+        delete Callback;
+    }
+}
+
+// Release the callback of a request the queue will never complete...
+static void DiscardRequest(RequestQueue::Request &Dropped, void *)
+{
+    Persistent<Function> *Callback =
+        static_cast<Persistent<Function> *>(Dropped.Context);
+    Callback->Reset();
+    delete Callback;
+}
+
+// Stop serving asynchronous draws...
+void ShutdownRequestQueue()
+{
+    delete RandomRequests;
+    RandomRequests = nullptr;
+}
+
+// Get the number of threads in libuv's threadpool...
+static size_t GetThreadpoolSize()
+{
+    // Libuv's own default, unless overridden the same way libuv is...
+    size_t Threads = 4;
+    const char *Variable = ::getenv("UV_THREADPOOL_SIZE");
+    if(Variable && ::atoi(Variable) > 0)
+        Threads = static_cast<size_t>(::atoi(Variable));
+
+    // Libuv's own limit...
+    return min<size_t>(Threads, 128);
+}
+
+// Check if a draw was cut short by a journal being replayed running out...
+static bool ThrowIfExhausted(Isolate *isolate, const bool CorrectionDetected)
+{
+    // A correction while we are still available is just a correction...
+    if(!CorrectionDetected || RandomNumberGenerator::GetInstance().IsAvailable())
+        return false;
+
+    // Throw a JavaScript exception within the virtual machine...
+    isolate->ThrowException(Exception::Error(
+    String::NewFromUtf8(isolate, "journal being replayed is exhausted")));
+    return true;
+}
+
+// Check that a number of bits for a prime was passed...
+static bool ValidatePrimeBits(
+    Isolate *isolate, const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Random number generator is not available...
+    if(!RandomNumberGenerator::GetInstance().IsAvailable())
+    {
+        // Throw a JavaScript exception within the virtual machine...
+        isolate->ThrowException(
+            Exception::TypeError(String::NewFromUtf8(
+                isolate, "random number generator is not available")));
+        return false;
+    }
+
+    // Insufficient in number...
+    if(Arguments.Length() < 1)
+    {
+        // Throw a JavaScript exception within the virtual machine...
+        isolate->ThrowException(Exception::TypeError(
+        String::NewFromUtf8(isolate, "expected a number of bits")));
+        return false;
+    }
+
+    // Incorrect type or out of range...
+    if(!Arguments[0]->IsUint32() ||
+       Arguments[0]->ToUint32()->Value() < 2 ||
+       Arguments[0]->ToUint32()->Value() > MaximumPrimeBits)
+    {
+        // Throw a JavaScript exception within the virtual machine...
+        isolate->ThrowException(Exception::RangeError(
+        String::NewFromUtf8(isolate, "expected a number of bits from 2 to 16384")));
+        return false;
+    }
+
+    // Valid...
+    return true;
+}
+
+// Get a pointer to the elements of the given typed array...
+template <typename Element_t>
+static Element_t *GetTypedArrayData(Local<Value> Array, size_t &Length)
+{
+    // Get the view and the buffer it looks into...
+    Local<TypedArray> View      = Local<TypedArray>::Cast(Array);
+    Local<ArrayBuffer> Buffer   = View->Buffer();
+
+    // Number of elements...
+    Length = View->Length();
+
+    // Locate the first element...
+    return reinterpret_cast<Element_t *>(
+        static_cast<uint8_t *>(Buffer->GetContents().Data()) +
+        View->ByteOffset());
+}
+
 }
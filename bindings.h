@@ -10,6 +10,7 @@
     #include <uv.h>
 
     // Our headers...
+    #include "bignum.h"
     #include "node-rng.h"
 
     // Standard C++...
@@ -18,29 +19,75 @@
 #else
     #include <cstdint>
 #endif
+    #include <atomic>
     #include <vector>
 
-// Work structure for asynchronous calls to be stored on heap...
-template <typename ResultType_t>
-struct Work
+// Work structure for asynchronous bulk fills to be stored on heap...
+struct FillWork
 {
-    Work() : Lower(0), Upper(0), CorrectionDetected(false), Result(0) {}
+    FillWork() : Words(nullptr), Length(0), CorrectionDetected(false) {}
 
     uv_work_t Request;
     v8::Persistent<v8::Function> Callback;
 
-    int32_t         Lower;
-    int32_t         Upper;
+    // Keeps the caller's array alive until it has been filled...
+    v8::Persistent<v8::Object> Array;
+
+    uint32_t       *Words;
+    size_t          Length;
     bool            CorrectionDetected;
-    ResultType_t    Result;
+};
+
+// Work structure for asynchronous prime searches to be stored on heap. One
+//  search is shared by several workers racing to find a prime first...
+struct PrimeWork
+{
+    PrimeWork() : Bits(0), Remaining(0), Found(false), CorrectionDetected(false) {}
+
+    std::vector<uv_work_t> Requests;
+    v8::Persistent<v8::Function> Callback;
+
+    uint32_t            Bits;
+
+    // Workers yet to complete, only touched on the event loop's thread...
+    size_t              Remaining;
+
+    // Set by the first worker to find a prime, which tells the rest to stop...
+    std::atomic<bool>   Found;
+    BigNumber           Prime;
+
+    std::atomic<bool>   CorrectionDetected;
 };
 
 // Callbacks for exported methods...
 namespace rng
 {
+    // Callback implementing JavaScript rng.fillBernoulli(array, probability)...
+    void fillBernoulli(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
+
+    // Callback implementing JavaScript rng.fillRandom(array)...
+    void fillRandom(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
+
+    // Callback implementing JavaScript
+    //  rng.fillRandomAsync(array, function(error, array))...
+    void fillRandomAsync(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
+
+    // Callback implementing JavaScript rng.fillRandomFloat(array)...
+    void fillRandomFloat(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
+
+    // Callback implementing JavaScript
+    //  rng.fillRandomRange(array, lower, upper)...
+    void fillRandomRange(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
+
+    // Callback implementing JavaScript rng.getCapabilities()...
+    void getCapabilities(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
+
     // Callback implementing JavaScript rng.getCorrections()...
     void getCorrections(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
 
+    // Callback implementing JavaScript rng.getKernels()...
+    void getKernels(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
+
     // Callback implementing JavaScript rng.getRandom()...
     void getRandom(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
 
@@ -48,6 +95,20 @@ namespace rng
     //  rng.getRandomAsync(function(error, result))...
     void getRandomAsync(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
 
+    // Callback implementing JavaScript rng.getRandomBelow(bound)...
+    void getRandomBelow(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
+
+    // Callback implementing JavaScript rng.getRandomBits(bits), also
+    //  exported as rng.randomBits(bits)...
+    void getRandomBits(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
+
+    // Callback implementing JavaScript rng.getRandomPrime(bits)...
+    void getRandomPrime(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
+
+    // Callback implementing JavaScript
+    //  rng.getRandomPrimeAsync(bits, function(error, result))...
+    void getRandomPrimeAsync(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
+
     // Callback implementing JavaScript rng.getRandomRange(lower, upper)...
     void getRandomRange(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
 
@@ -55,11 +116,32 @@ namespace rng
     //  rng.getRandomRangeAsync(lower, upper, function(error, result))...
     void getRandomRangeAsync(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
 
+    // Callback implementing JavaScript rng.getSource()...
+    void getSource(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
+
+    // Callback implementing JavaScript rng.getSourceStatistics()...
+    void getSourceStatistics(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
+
     // rng.getVersion()...
     void getVersion(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
 
     // Callback implementing JavaScript rng.isAvailable()...
     void isAvailable(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
+
+    // Callback implementing JavaScript rng.recordJournal(path)...
+    void recordJournal(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
+
+    // Callback implementing JavaScript rng.replayJournal(path)...
+    void replayJournal(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
+
+    // Callback implementing JavaScript rng.setSource(name)...
+    void setSource(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
+
+    // Callback implementing JavaScript rng.stopJournal()...
+    void stopJournal(const v8::FunctionCallbackInfo<v8::Value> &Arguments);
+
+    // Stop serving asynchronous draws, when the module is unloaded...
+    void ShutdownRequestQueue();
 }
 
 
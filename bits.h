@@ -0,0 +1,151 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Multiple include protection...
+#ifndef _BIT_RESERVOIR_H_
+#define _BIT_RESERVOIR_H_
+
+// Includes...
+
+    // Our headers...
+    #include "arena.h"
+
+    // Standard C++...
+#ifdef __APPLE__
+    #include <tr1/cstdint>
+#else
+    #include <cstdint>
+#endif
+    #include <algorithm>
+    #include <cstddef>
+
+// Serves random bits most significant first, a few at a time, out of words
+//  drawn in bulk from a generator. Callers peek at a 64-bit window and then
+//  consume only as many bits as they actually looked at, so no randomness is
+//  wasted...
+template <class Generator_t>
+class BitReservoir
+{
+    // Public methods...
+    public:
+
+        // Constructor. The hint is how many bits the caller expects to need,
+        //  so small requests don't drain a whole chunk of words...
+        BitReservoir(Generator_t &Generator, const size_t ExpectedBits)
+            : m_Generator(Generator),
+              m_ChunkWords(
+                std::min<size_t>(ChunkWords, ExpectedBits / 64 + 2)),
+              m_Next(0),
+              m_Drawn(0),
+              m_Current(0),
+              m_Available(0),
+              m_Lookahead(0),
+              m_CorrectionDetected(false)
+        {
+            // Load the first word into the window...
+            m_Current   = Draw();
+            m_Available = 64;
+            m_Lookahead = Draw();
+        }
+
+        // Consume the given number of bits, from one to sixty-four. At least
+        //  one bit always remains available afterwards...
+        void Consume(const unsigned Bits)
+        {
+            // All from the current word...
+            if(Bits < m_Available)
+            {
+                m_Current   <<= Bits;
+                m_Available -=  Bits;
+                return;
+            }
+
+            // Spill into the lookahead word, which then becomes current...
+            const unsigned Spill = Bits - m_Available;
+            m_Current   = (Spill < 64) ? (m_Lookahead << Spill) : 0;
+            m_Available = 64 - Spill;
+            m_Lookahead = Draw();
+        }
+
+        // Check if the generator detected a correction for any bit drawn...
+        bool GetCorrectionDetected() const { return m_CorrectionDetected; }
+
+        // Get the next sixty-four bits without consuming them...
+        uint64_t Peek() const
+        {
+            return (m_Available == 64)
+                ? m_Current
+                : (m_Current | (m_Lookahead >> m_Available));
+        }
+
+        // Deconstructor...
+       ~BitReservoir()
+        {
+            // Wipe anything not served...
+            SecureWipe(m_Chunk, sizeof(m_Chunk));
+            m_Current = m_Lookahead = 0;
+        }
+
+    // Protected methods...
+    protected:
+
+        // Draw the next whole word, refilling the chunk as needed...
+        uint64_t Draw()
+        {
+            // Out of words...
+            if(m_Next == m_Drawn)
+            {
+                bool CorrectionDetected = false;
+                m_Generator.FillRandom64(m_Chunk, m_ChunkWords, CorrectionDetected);
+                m_CorrectionDetected |= CorrectionDetected;
+                m_Next  = 0;
+                m_Drawn = m_ChunkWords;
+            }
+
+            // Serve...
+            return m_Chunk[m_Next++];
+        }
+
+    // Private methods...
+    private:
+
+        // Forbid copy constructor and assignment...
+        BitReservoir(const BitReservoir &);
+        BitReservoir &operator=(const BitReservoir &);
+
+    // Protected attributes...
+    protected:
+
+        // Most words drawn from the generator at once...
+        static const size_t ChunkWords = 64;
+
+        // Generator words are drawn from...
+        Generator_t    &m_Generator;
+
+        // Words drawn per refill...
+        const size_t    m_ChunkWords;
+
+        // Words drawn and the next to be served...
+        uint64_t        m_Chunk[ChunkWords];
+        size_t          m_Next;
+        size_t          m_Drawn;
+
+        // Unconsumed bits, left aligned, and how many of them there are...
+        uint64_t        m_Current;
+        unsigned        m_Available;
+
+        // Word following the current one...
+        uint64_t        m_Lookahead;
+
+        // Whether any draw needed a correction...
+        bool            m_CorrectionDetected;
+};
+
+// Storage for the constant above, which std::min() takes by reference...
+template <class Generator_t>
+const size_t BitReservoir<Generator_t>::ChunkWords;
+
+#endif
+
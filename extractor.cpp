@@ -0,0 +1,226 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Includes...
+
+    // Ours...
+    #include "arena.h"
+    #include "extractor.h"
+    #include "hardware.h"
+    #include "siphash.h"
+
+    // POSIX...
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <unistd.h>
+#ifdef __linux__
+    #include <sys/syscall.h>
+#endif
+
+    // Standard C++...
+    #include <algorithm>
+    #include <cstring>
+
+// Using the standard namespace...
+using namespace std;
+
+// Constructor...
+EntropyExtractor::EntropyExtractor(
+    const bool UseRdSeed, const KernelTable &Kernels)
+    : m_UseRdSeed(UseRdSeed),
+      m_Keyed(false),
+      m_Kernels(Kernels),
+      m_Counter(0),
+      m_Available(0)
+{
+    // Not keyed until first use...
+    m_Key[0] = m_Key[1] = 0;
+}
+
+// Throw away any unserved output and rekey on next use...
+void EntropyExtractor::Discard()
+{
+    SecureWipe(m_Output, sizeof(m_Output));
+    m_Available = 0;
+    m_Keyed     = false;
+}
+
+// Fill the given words with extracted output...
+uint32_t EntropyExtractor::Extract(uint64_t *Words, const size_t Count)
+{
+    // Number of RDRAND retries...
+    uint32_t Corrections = 0;
+
+    // Initial key comes from the kernel and RDSEED, if present...
+    if(!m_Keyed)
+    {
+        Reseed();
+        m_Keyed = true;
+    }
+
+    // Keep serving until caller has everything they asked for...
+    for(size_t Served = 0; Served < Count;)
+    {
+        // Out of output, so extract another block...
+        if(!m_Available)
+            Corrections += Refill();
+
+        // Serve as much as we can from the back of the block, wiping what
+        //  was served so it can't be handed out again...
+        const size_t Take = min(Count - Served, m_Available);
+        m_Available -= Take;
+      ::memcpy(&Words[Served], &m_Output[m_Available], Take * sizeof(uint64_t));
+        SecureWipe(&m_Output[m_Available], Take * sizeof(uint64_t));
+        Served += Take;
+    }
+
+    // Done...
+    return Corrections;
+}
+
+// Add how much each source has contributed so far to the given totals...
+void EntropyExtractor::GetStatistics(Statistics &Totals) const
+{
+    Totals.RdRandWords      += m_Counters.RdRandWords.load(memory_order_relaxed);
+    Totals.RdSeedWords      += m_Counters.RdSeedWords.load(memory_order_relaxed);
+    Totals.RdSeedFailures   += m_Counters.RdSeedFailures.load(memory_order_relaxed);
+    Totals.SystemBytes      += m_Counters.SystemBytes.load(memory_order_relaxed);
+    Totals.Blocks           += m_Counters.Blocks.load(memory_order_relaxed);
+}
+
+// Produce a fresh block of output...
+uint32_t EntropyExtractor::Refill()
+{
+    // Number of RDRAND retries...
+    uint32_t Corrections = 0;
+
+    // Gather a block of RDRAND words...
+    for(size_t Index = 0; Index < BlockWords; ++Index)
+    {
+        while(!RdRand64Step(m_Input[Index]))
+            ++Corrections;
+    }
+    Counters::Add(m_Counters.RdRandWords, BlockWords);
+
+    // Fresh key for this block...
+    Reseed();
+
+    // Compress each word along with its position in the stream...
+    m_Kernels.Extract(m_Key, m_Input, m_Output, BlockWords, m_Counter);
+
+    // Advance the counter past this block...
+    m_Counter += BlockWords;
+    m_Available = BlockWords;
+    Counters::Add(m_Counters.Blocks, 1);
+
+    // Don't leave raw input lying around...
+    SecureWipe(m_Input, sizeof(m_Input));
+
+    // Done...
+    return Corrections;
+}
+
+// Derive the next key from the current one and fresh entropy...
+void EntropyExtractor::Reseed()
+{
+    // Key material is the block counter, two words from the kernel, an
+    //  RDSEED word, and our process ID so that copies of this state in forked
+    //  processes diverge even if both other sources fail...
+    uint64_t Material[5] = {
+        m_Counter, 0, 0, 0, static_cast<uint64_t>(::getpid()) };
+
+    // Read from the kernel...
+    if(ReadSystemEntropy(&Material[1], 2 * sizeof(uint64_t)))
+        Counters::Add(m_Counters.SystemBytes, 2 * sizeof(uint64_t));
+
+    // RDSEED is allowed to run dry under load. Rather than stalling the
+    //  block, carry on without it and try again next block...
+    if(m_UseRdSeed)
+    {
+        if(RdSeed64Step(Material[3]))
+            Counters::Add(m_Counters.RdSeedWords, 1);
+        else
+            Counters::Add(m_Counters.RdSeedFailures, 1);
+    }
+
+    // Derive the next key from the current key and the material...
+    const uint64_t Key[2] = { m_Key[0], m_Key[1] };
+    m_Key[0] = SipHash(Key, Material, 5);
+    Material[0] = ~Material[0];
+    m_Key[1] = SipHash(Key, Material, 5);
+
+    // Wipe...
+    SecureWipe(Material, sizeof(Material));
+}
+
+// Deconstructor...
+EntropyExtractor::~EntropyExtractor()
+{
+    // Wipe key and any unserved output...
+    SecureWipe(m_Key, sizeof(m_Key));
+    SecureWipe(m_Output, sizeof(m_Output));
+}
+
+// Fill the given buffer from the operating system's random number generator...
+bool ReadSystemEntropy(void *Buffer, const size_t Bytes)
+{
+    // Cursor into the caller's buffer...
+    uint8_t *Cursor     = static_cast<uint8_t *>(Buffer);
+    size_t   Remaining  = Bytes;
+
+#ifdef SYS_getrandom
+    // Prefer the system call, which needs no file descriptor...
+    while(Remaining)
+    {
+        const long Read = ::syscall(SYS_getrandom, Cursor, Remaining, 0);
+
+        // Interrupted, so try again...
+        if(Read < 0 && errno == EINTR)
+            continue;
+
+        // Kernel too old, so fall back to the device below...
+        if(Read < 0)
+            break;
+
+        // Advance...
+        Cursor      += Read;
+        Remaining   -= static_cast<size_t>(Read);
+    }
+
+    // Done...
+    if(!Remaining)
+        return true;
+#endif
+
+    // Open the device...
+    const int Device = ::open("/dev/urandom", O_RDONLY);
+    if(Device == -1)
+        return false;
+
+    // Read until the caller has everything they asked for...
+    while(Remaining)
+    {
+        const ssize_t Read = ::read(Device, Cursor, Remaining);
+
+        // Interrupted, so try again...
+        if(Read < 0 && errno == EINTR)
+            continue;
+
+        // Failed...
+        if(Read <= 0)
+            break;
+
+        // Advance...
+        Cursor      += Read;
+        Remaining   -= static_cast<size_t>(Read);
+    }
+
+    // Cleanup...
+  ::close(Device);
+
+    // Done...
+    return (Remaining == 0);
+}
+
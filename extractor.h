@@ -0,0 +1,158 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Multiple include protection...
+#ifndef _ENTROPY_EXTRACTOR_H_
+#define _ENTROPY_EXTRACTOR_H_
+
+// Includes...
+
+    // Our headers...
+    #include "kernels.h"
+
+    // Standard C++...
+#ifdef __APPLE__
+    #include <tr1/cstdint>
+#else
+    #include <cstdint>
+#endif
+    #include <atomic>
+    #include <cstddef>
+
+// Combines RDRAND, RDSEED and the operating system's random number generator
+//  so that output remains unpredictable as long as any one of them is sound.
+//  Every RDRAND word is compressed through SipHash-2-4 under a secret key, and
+//  the key is re-derived once per block from fresh kernel and RDSEED entropy.
+//  Working a block at a time keeps the system call and the slow RDSEED off of
+//  the per word path. Not thread safe, so each thread keeps its own...
+class EntropyExtractor
+{
+    // Public attributes...
+    public:
+
+        // How much each source has contributed so far...
+        struct Statistics
+        {
+            Statistics()
+                : RdRandWords(0),
+                  RdSeedWords(0),
+                  RdSeedFailures(0),
+                  SystemBytes(0),
+                  Blocks(0) {}
+
+            uint64_t    RdRandWords;
+            uint64_t    RdSeedWords;
+            uint64_t    RdSeedFailures;
+            uint64_t    SystemBytes;
+            uint64_t    Blocks;
+        };
+
+        // Number of words extracted per block...
+        static const size_t BlockWords = 256;
+
+        // Running totals, written only by the owning thread but readable from
+        //  any other...
+        struct Counters
+        {
+            Counters()
+                : RdRandWords(0),
+                  RdSeedWords(0),
+                  RdSeedFailures(0),
+                  SystemBytes(0),
+                  Blocks(0) {}
+
+            // Add to one of them...
+            static void Add(std::atomic<uint64_t> &Counter, const uint64_t Amount)
+            {
+                Counter.store(
+                    Counter.load(std::memory_order_relaxed) + Amount,
+                    std::memory_order_relaxed);
+            }
+
+            std::atomic<uint64_t>   RdRandWords;
+            std::atomic<uint64_t>   RdSeedWords;
+            std::atomic<uint64_t>   RdSeedFailures;
+            std::atomic<uint64_t>   SystemBytes;
+            std::atomic<uint64_t>   Blocks;
+        };
+
+    // Public methods...
+    public:
+
+        // Constructor, which compresses with the given bulk kernels. Keying
+        //  from the kernel and RDSEED, if present, is deferred until first
+        //  use...
+        EntropyExtractor(const bool UseRdSeed, const KernelTable &Kernels);
+
+        // Throw away any unserved output and rekey from fresh entropy on next
+        //  use, such as when this state may have been duplicated into another
+        //  process by fork()...
+        void Discard();
+
+        // Fill the given words with extracted output, returning the number of
+        //  times RDRAND had to be retried...
+        uint32_t Extract(uint64_t *Words, const size_t Count);
+
+        // Add how much each source has contributed so far to the given
+        //  totals. Safe to call from any thread...
+        void GetStatistics(Statistics &Totals) const;
+
+        // Deconstructor...
+       ~EntropyExtractor();
+
+    // Protected methods...
+    protected:
+
+        // Produce a fresh block of output, returning the number of times
+        //  RDRAND had to be retried...
+        uint32_t Refill();
+
+        // Derive the next key from the current one and fresh kernel and RDSEED
+        //  entropy...
+        void Reseed();
+
+    // Private methods...
+    private:
+
+        // Forbid copy constructor and assignment...
+        EntropyExtractor(const EntropyExtractor &);
+        EntropyExtractor &operator=(const EntropyExtractor &);
+
+    // Protected attributes...
+    protected:
+
+        // Whether RDSEED is present to reseed the key...
+        const bool          m_UseRdSeed;
+
+        // Whether the key has been derived yet...
+        bool                m_Keyed;
+
+        // Bulk kernels used for compression...
+        const KernelTable  &m_Kernels;
+
+        // SipHash key...
+        uint64_t    m_Key[2];
+
+        // Block counter, so identical inputs never yield identical output...
+        uint64_t    m_Counter;
+
+        // Raw RDRAND input to the block being extracted. Kept here rather
+        //  than on the stack so it shares our owner's protected storage...
+        uint64_t    m_Input[BlockWords];
+
+        // Extracted output not yet served and how much of it remains...
+        uint64_t    m_Output[BlockWords];
+        size_t      m_Available;
+
+        // Contribution of each source...
+        Counters    m_Counters;
+};
+
+// Fill the given buffer from the operating system's random number generator,
+//  returning false if it could not be read...
+bool ReadSystemEntropy(void *Buffer, const size_t Bytes);
+
+#endif
+
@@ -0,0 +1,129 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Includes...
+
+    // Ours...
+    #include "hardware.h"
+
+    // Libuv...
+    #include <uv.h>
+
+// What this host supports, once probed...
+static HostCapabilities Capabilities =
+    { false, false, false, false, false, KernelBaseline };
+
+// Ensures the host is only probed once...
+static uv_once_t ProbeOnce = UV_ONCE_INIT;
+
+// Probe the CPU for the instructions we can use...
+static void ProbeHost()
+{
+    // Verify CPU supports CPUID instruction...
+
+        // Storage for EFLAGS register...
+        uint64_t    EFlagsBefore    = 0;
+        uint64_t    EFlagsAfter     = 0;
+
+        // Get EFLAGS register...
+        asm volatile(
+            "pushfq\n"
+            "pop %0\n"
+            : "=r"(EFlagsBefore));
+
+        // Set EFLAGS' ID bit. This bit is modifiable only when the CPUID
+        //  instruction is supported...
+        asm volatile(
+            "push %0\n"
+            "popfq\n"
+            :: "r"(EFlagsBefore ^ 0x200000)); /* Input operands */
+
+        // Get the EFLAGS register again...
+        asm volatile(
+            "pushfq\n"
+            "pop %0\n"
+            : "=r"(EFlagsAfter));   /* Output operands */
+
+        // Not supported if the bit isn't still set...
+        if(!(EFlagsAfter & 0x200000))
+            return;
+
+    // Query CPU for capabilities...
+
+        // Output registers...
+        uint32_t EAX = 0;
+        uint32_t EBX = 0;
+        uint32_t ECX = 0;
+        uint32_t EDX = 0;
+
+        // Query highest standard leaf...
+        asm volatile(
+            "cpuid"
+            : "=a" (EAX), "=b" (EBX), "=c" (ECX), "=d" (EDX) /* Output operands */
+            : "a" (0)); /* Input operands */
+        const uint32_t HighestLeaf = EAX;
+
+        // Query...
+        asm volatile(
+            "cpuid"
+            : "=a" (EAX), "=b" (EBX), "=c" (ECX), "=d" (EDX) /* Output operands */
+            : "a" (1)); /* Input operands */
+
+        // Check for RdRand and AES instructions...
+        Capabilities.RdRand = (ECX & (1 << 30)) != 0;
+        Capabilities.AesNi  = (ECX & (1 << 25)) != 0;
+
+        // AVX state can only be used if the operating system saves it on a
+        //  context switch...
+        const bool HasAvx = (ECX & (1 << 27)) && (ECX & (1 << 28));
+        uint32_t EnabledState = 0;
+        if(HasAvx)
+        {
+            uint32_t EnabledStateHigh = 0;
+            asm volatile(
+                "xgetbv"
+                : "=a" (EnabledState), "=d" (EnabledStateHigh) /* Output operands */
+                : "c" (0)); /* Input operands */
+        }
+
+        // YMM state, and ZMM along with opmask state...
+        const bool SavesAvx     = HasAvx && (EnabledState & 0x06) == 0x06;
+        const bool SavesAvx512  = HasAvx && (EnabledState & 0xe6) == 0xe6;
+
+        // Query structured extended features...
+        if(HighestLeaf >= 7)
+        {
+            asm volatile(
+                "cpuid"
+                : "=a" (EAX), "=b" (EBX), "=c" (ECX), "=d" (EDX) /* Output operands */
+                : "a" (7), "c" (0)); /* Input operands */
+
+            // Check for RdSeed instruction...
+            Capabilities.RdSeed = (EBX & (1 << 18)) != 0;
+
+            // Vector instruction sets usable here...
+            Capabilities.Avx2   = SavesAvx && (EBX & (1 << 5));
+            Capabilities.Avx512 = SavesAvx512 && (EBX & (1 << 16));
+
+            // Pick the widest kernels the host and operating system support.
+            //  AVX-512 kernels need the foundation, DQ, BW and VL subsets, and
+            //  both need BMI2...
+            const uint32_t Avx512Bits =
+                (1U << 16) | (1U << 17) | (1U << 30) | (1U << 31);
+            if(SavesAvx512 && (EBX & Avx512Bits) == Avx512Bits &&
+               (EBX & (1 << 5)) && (EBX & (1 << 8)))
+                Capabilities.Kernels = KernelAvx512;
+            else if(SavesAvx && (EBX & (1 << 5)) && (EBX & (1 << 8)))
+                Capabilities.Kernels = KernelAvx2;
+        }
+}
+
+// Get what this host supports, probing it the first time...
+const HostCapabilities &GetHostCapabilities()
+{
+  ::uv_once(&ProbeOnce, ProbeHost);
+    return Capabilities;
+}
+
@@ -0,0 +1,84 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Multiple include protection...
+#ifndef _HARDWARE_H_
+#define _HARDWARE_H_
+
+// Includes...
+
+    // Our headers...
+    #include "kernels.h"
+
+    // Standard C++...
+#ifdef __APPLE__
+    #include <tr1/cstdint>
+#else
+    #include <cstdint>
+#endif
+
+// What the host's processor and operating system support...
+struct HostCapabilities
+{
+    // Intel Secure Key's DRBG and entropy conditioner...
+    bool        RdRand;
+    bool        RdSeed;
+
+    // AES instructions...
+    bool        AesNi;
+
+    // Vector instruction sets, only when the operating system also saves
+    //  their register state...
+    bool        Avx2;
+    bool        Avx512;
+
+    // Widest bulk kernels the above allow...
+    KernelLevel Kernels;
+};
+
+// Get what this host supports. The processor is only probed the first time
+//  this is called, from whichever thread gets there first...
+const HostCapabilities &GetHostCapabilities();
+
+// Query the DRBG seeded hardware random number generator once, returning false
+//  if the carry flag indicates the result was not valid...
+inline bool RdRand64Step(uint64_t &Result)
+{
+    // Carry flag...
+    uint8_t Valid = false;
+
+    // Perform query and retrieve carry flag...
+    asm volatile(
+        "rdrand %0\n"
+        "setc %1"
+        : "=r" (Result), "=qm"(Valid)
+        :
+        : "cc");
+
+    // Done...
+    return Valid;
+}
+
+// Query the hardware entropy conditioner once, returning false if the carry
+//  flag indicates it had no fresh entropy to give...
+inline bool RdSeed64Step(uint64_t &Result)
+{
+    // Carry flag...
+    uint8_t Valid = false;
+
+    // Perform query and retrieve carry flag...
+    asm volatile(
+        "rdseed %0\n"
+        "setc %1"
+        : "=r" (Result), "=qm"(Valid)
+        :
+        : "cc");
+
+    // Done...
+    return Valid;
+}
+
+#endif
+
@@ -1,8 +1,57 @@
 var rng = require('./build/Release/rng');
 
-if(!rng.isAvailable())
+// Loading is kept cheap, so the host is not probed until something needs it.
+//  Methods that draw throw if there is no hardware random number generator...
+
+// What this host's processor supports, probed once and then cached...
+var capabilities = null;
+rng.capabilities = function()
+{
+  if(!capabilities)
+    capabilities = Object.freeze(rng.getCapabilities());
+
+  return capabilities;
+};
+
+// Convert a big endian Buffer to a BigInt...
+function bufferToBigInt(buffer)
 {
-  throw new Error("Hardware RNG is not available");
+  return buffer.length ? BigInt('0x' + buffer.toString('hex')) : BigInt(0);
 }
 
+// Convert a non-negative BigInt to a big endian Buffer...
+function bigIntToBuffer(value)
+{
+  var hex = value.toString(16);
+  return Buffer.from((hex.length % 2 ? '0' : '') + hex, 'hex');
+}
+
+// Random BigInt uniformly distributed in [0, 2^bits)...
+rng.randomBigInt = function(bits)
+{
+  // Random bits are served least significant byte first...
+  return bufferToBigInt(Buffer.from(rng.getRandomBits(bits)).reverse());
+};
+
+// Random BigInt uniformly distributed in [0, bound)...
+rng.randomBelow = function(bound)
+{
+  if(typeof bound !== 'bigint' || bound <= BigInt(0))
+    throw new RangeError("expected a BigInt bound above zero");
+
+  return bufferToBigInt(rng.getRandomBelow(bigIntToBuffer(bound)));
+};
+
+// Random probable prime BigInt of exactly the given number of bits, searched
+//  for on half the threads of the pool at once if a callback is given...
+rng.randomPrime = function(bits, callback)
+{
+  if(!callback)
+    return bufferToBigInt(rng.getRandomPrime(bits));
+
+  rng.getRandomPrimeAsync(bits, function(error, result) {
+    callback(error, bufferToBigInt(result));
+  });
+};
+
 module.exports = rng;
@@ -0,0 +1,333 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Includes...
+
+    // Ours...
+    #include "journal.h"
+
+    // POSIX...
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+
+    // Standard C++...
+    #include <algorithm>
+    #include <cstring>
+
+// Using the standard namespace...
+using namespace std;
+
+// Identifies a journal file and its format revision...
+static const char       JournalMagic[8] = { 'N', 'R', 'N', 'G', 'J', 'R', 'N', 'L' };
+static const uint32_t   JournalVersion  = 1;
+
+// Open the journal at the given path in the given mode...
+RandomJournal::RandomJournal(const string &Path, const ModeType Mode)
+    : m_Mode(Mode),
+      m_File(-1),
+      m_Next(0),
+      m_Missing(UINT64_MAX),
+      m_Capacity(0),
+      m_Mapping(nullptr),
+      m_MappingBytes(0)
+{
+    // Allocate mutex...
+  ::uv_mutex_init(&m_Mutex);
+
+    // No chunks are mapped yet...
+    for(size_t Chunk = 0; Chunk < MaximumChunks; ++Chunk)
+        m_Chunks[Chunk].store(nullptr, memory_order_relaxed);
+
+    // Recording...
+    if(Mode == Recording)
+    {
+        // Create or truncate the journal...
+        m_File = ::open(Path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if(m_File == -1)
+            return;
+
+        // Map the first chunk which also holds the header...
+        uint8_t *First = MapChunk(0);
+        if(!First)
+        {
+          ::close(m_File);
+            m_File = -1;
+            return;
+        }
+
+        // Stamp the header. Word count is filled in when closed...
+        Header *JournalHeader = reinterpret_cast<Header *>(First);
+        ::memcpy(JournalHeader->Magic, JournalMagic, sizeof(JournalMagic));
+        JournalHeader->Version  = JournalVersion;
+        JournalHeader->WordSize = sizeof(uint64_t);
+        JournalHeader->Words    = 0;
+        JournalHeader->Reserved = 0;
+
+        // Words can be recorded up until the last chunk is full...
+        m_Capacity = (ChunkBytes * MaximumChunks - sizeof(Header))
+                   / sizeof(uint64_t);
+    }
+
+    // Replaying...
+    else
+    {
+        // Open the journal...
+        m_File = ::open(Path.c_str(), O_RDONLY);
+        if(m_File == -1)
+            return;
+
+        // Get its size and make sure it is at least big enough for a header...
+        struct stat Status;
+        if(::fstat(m_File, &Status) != 0 ||
+           static_cast<size_t>(Status.st_size) < sizeof(Header))
+        {
+          ::close(m_File);
+            m_File = -1;
+            return;
+        }
+
+        // Map the whole thing read only...
+        m_MappingBytes = static_cast<size_t>(Status.st_size);
+        void *Mapping = ::mmap(
+            nullptr, m_MappingBytes, PROT_READ, MAP_PRIVATE, m_File, 0);
+        if(Mapping == MAP_FAILED)
+        {
+          ::close(m_File);
+            m_File = -1;
+            return;
+        }
+        m_Mapping = static_cast<const uint8_t *>(Mapping);
+
+        // Words are consumed front to back exactly once...
+      ::madvise(Mapping, m_MappingBytes, MADV_SEQUENTIAL);
+
+        // Validate the header...
+        const Header *JournalHeader = reinterpret_cast<const Header *>(m_Mapping);
+        if(::memcmp(JournalHeader->Magic, JournalMagic, sizeof(JournalMagic)) != 0 ||
+           JournalHeader->Version != JournalVersion ||
+           JournalHeader->WordSize != sizeof(uint64_t))
+        {
+          ::munmap(Mapping, m_MappingBytes);
+            m_Mapping = nullptr;
+          ::close(m_File);
+            m_File = -1;
+            return;
+        }
+
+        // Never trust the header beyond what the file actually contains...
+        m_Capacity = min<uint64_t>(
+            JournalHeader->Words,
+            (m_MappingBytes - sizeof(Header)) / sizeof(uint64_t));
+    }
+}
+
+// Get the number of words recorded or replayed so far...
+uint64_t RandomJournal::GetWords() const
+{
+    return min<uint64_t>(
+        min<uint64_t>(m_Next.load(memory_order_relaxed), m_Capacity),
+        m_Missing.load(memory_order_acquire));
+}
+
+// Map the given chunk of a journal being recorded...
+uint8_t *RandomJournal::MapChunk(const size_t Chunk)
+{
+    // Journal is full...
+    if(Chunk >= MaximumChunks)
+        return nullptr;
+
+    // Only one thread may extend the file at a time...
+  ::uv_mutex_lock(&m_Mutex);
+
+    // Another thread may have beaten us to it...
+    uint8_t *Mapping = m_Chunks[Chunk].load(memory_order_acquire);
+
+    // Extend the file to cover the chunk and map it...
+    if(!Mapping &&
+       ::ftruncate(m_File, static_cast<off_t>((Chunk + 1) * ChunkBytes)) == 0)
+    {
+        void *Address = ::mmap(
+            nullptr, ChunkBytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_File,
+            static_cast<off_t>(Chunk * ChunkBytes));
+
+        // Publish for the lock free fast path...
+        if(Address != MAP_FAILED)
+        {
+            Mapping = static_cast<uint8_t *>(Address);
+            m_Chunks[Chunk].store(Mapping, memory_order_release);
+        }
+    }
+
+  ::uv_mutex_unlock(&m_Mutex);
+
+    // Done...
+    return Mapping;
+}
+
+// Append words to a journal being recorded...
+void RandomJournal::Record(const uint64_t *Words, const size_t Count)
+{
+    // Reserve a contiguous run of slots for our words...
+    const uint64_t First = m_Next.fetch_add(Count, memory_order_relaxed);
+
+    // Store each word, which may cross into a new chunk part way through...
+    size_t Index = 0;
+    for(; Index < Count; ++Index)
+    {
+        // Journal is full, so drop the remainder...
+        if(First + Index >= m_Capacity)
+            break;
+
+        // Locate the word's chunk and offset within it...
+        const uint64_t Offset =
+            sizeof(Header) + (First + Index) * sizeof(uint64_t);
+        const size_t Chunk = static_cast<size_t>(Offset / ChunkBytes);
+
+        // Map the chunk if nobody has yet. If we can't, the words we
+        //  reserved are lost and nothing from them on can be replayed...
+        uint8_t *Mapping = m_Chunks[Chunk].load(memory_order_acquire);
+        if(!Mapping && !(Mapping = MapChunk(Chunk)))
+        {
+            MarkMissing(First + Index);
+            break;
+        }
+
+        // Store...
+      ::memcpy(Mapping + (Offset % ChunkBytes), &Words[Index], sizeof(uint64_t));
+    }
+
+    // Count whatever we stored in the header straight away, rather than only
+    //  when closed, so a recording survives its process crashing...
+    if(Index)
+        CommitWords(min<uint64_t>(
+            First + Index, m_Missing.load(memory_order_acquire)));
+}
+
+// Lower the number of words that can be replayed to the given word, which
+//  could not be stored...
+void RandomJournal::MarkMissing(const uint64_t Word)
+{
+    // Only ever lower it...
+    uint64_t Current = m_Missing.load(memory_order_relaxed);
+    while(Current > Word &&
+          !m_Missing.compare_exchange_weak(
+            Current, Word, memory_order_acq_rel, memory_order_relaxed))
+        ;
+
+    // Pull back a header count another thread may already have raised past
+    //  it, so that a crash from here on doesn't replay the gap as zeroes...
+    uint64_t *Count =
+        &reinterpret_cast<Header *>(m_Chunks[0].load(memory_order_acquire))->Words;
+    uint64_t Committed = __atomic_load_n(Count, __ATOMIC_RELAXED);
+    while(Committed > Word &&
+          !__atomic_compare_exchange_n(
+            Count, &Committed, Word, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+// Raise the word count in the header of a journal being recorded...
+void RandomJournal::CommitWords(const uint64_t Words)
+{
+    // Header lives at the start of the first chunk, which is always mapped...
+    uint64_t *Count =
+        &reinterpret_cast<Header *>(m_Chunks[0].load(memory_order_acquire))->Words;
+
+    // Threads finish storing their words out of order, so only ever raise
+    //  it. Should we die, words another thread had reserved below this but
+    //  not yet stored replay as zeroes, but no draw that returned is lost...
+    uint64_t Current = __atomic_load_n(Count, __ATOMIC_RELAXED);
+    while(Current < Words &&
+          !__atomic_compare_exchange_n(
+            Count, &Current, Words, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+// Serve up to the requested number of words from a journal being replayed...
+size_t RandomJournal::Replay(uint64_t *Words, const size_t Count)
+{
+    // Claim a contiguous run of recorded words...
+    const uint64_t First = m_Next.fetch_add(Count, memory_order_relaxed);
+
+    // Journal is exhausted...
+    if(First >= m_Capacity)
+        return 0;
+
+    // Copy out as many as were recorded...
+    const size_t Available =
+        static_cast<size_t>(min<uint64_t>(Count, m_Capacity - First));
+  ::memcpy(
+        Words,
+        m_Mapping + sizeof(Header) + First * sizeof(uint64_t),
+        Available * sizeof(uint64_t));
+
+    // Done...
+    return Available;
+}
+
+// Close a recording without finalizing it...
+void RandomJournal::Abandon()
+{
+    // Release each chunk mapping without touching what it holds...
+    for(size_t Chunk = 0; Chunk < MaximumChunks; ++Chunk)
+    {
+        uint8_t *Mapping = m_Chunks[Chunk].exchange(nullptr, memory_order_acq_rel);
+        if(Mapping)
+          ::munmap(Mapping, ChunkBytes);
+    }
+
+    // Release the replay mapping...
+    if(m_Mapping)
+      ::munmap(const_cast<uint8_t *>(m_Mapping), m_MappingBytes);
+    m_Mapping = nullptr;
+
+    // Close the file, leaving nothing for the deconstructor to finalize...
+    if(IsOpen())
+      ::close(m_File);
+    m_File = -1;
+}
+
+// Flush and close the journal...
+RandomJournal::~RandomJournal()
+{
+    // Finalize a recording...
+    if(IsOpen() && m_Mode == Recording)
+    {
+        // Store the final word count in the header, which is only as far as
+        //  words were actually stored...
+        const uint64_t Words = GetWords();
+        uint8_t *First = m_Chunks[0].load(memory_order_acquire);
+        reinterpret_cast<Header *>(First)->Words = Words;
+
+        // Release each chunk mapping...
+        for(size_t Chunk = 0; Chunk < MaximumChunks; ++Chunk)
+        {
+            uint8_t *Mapping = m_Chunks[Chunk].load(memory_order_acquire);
+            if(Mapping)
+              ::munmap(Mapping, ChunkBytes);
+        }
+
+        // Trim the file back to exactly what was stored...
+        if(::ftruncate(
+            m_File,
+            static_cast<off_t>(sizeof(Header) + Words * sizeof(uint64_t))) != 0)
+        {
+            // Nothing more we can do, the header still bounds replay...
+        }
+    }
+
+    // Release the replay mapping...
+    if(m_Mapping)
+      ::munmap(const_cast<uint8_t *>(m_Mapping), m_MappingBytes);
+
+    // Close the file...
+    if(IsOpen())
+      ::close(m_File);
+
+    // Cleanup mutex...
+  ::uv_mutex_destroy(&m_Mutex);
+}
+
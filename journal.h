@@ -0,0 +1,154 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Multiple include protection...
+#ifndef _RANDOM_JOURNAL_H_
+#define _RANDOM_JOURNAL_H_
+
+// Includes...
+
+    // Libuv...
+    #include <uv.h>
+
+    // Standard C++...
+#ifdef __APPLE__
+    #include <tr1/cstdint>
+#else
+    #include <cstdint>
+#endif
+    #include <atomic>
+    #include <cstddef>
+    #include <string>
+
+// Memory mapped log of every 64-bit word served by the random number
+//  generator. While recording, words are stored straight into shared file
+//  mappings so the kernel writes them back off of the hot path. While
+//  replaying, words are served back out of a read only mapping of the file
+//  without any system calls...
+class RandomJournal
+{
+    // Public attributes...
+    public:
+
+        // Whether the journal is capturing or serving words...
+        typedef enum
+        {
+            Recording,  /* Words served are appended to the journal. */
+            Replaying   /* Words served are read back from the journal. */
+
+        }ModeType;
+
+    // Public methods...
+    public:
+
+        // Open the journal at the given path in the given mode. Check
+        //  IsOpen() afterwards...
+        RandomJournal(const std::string &Path, const ModeType Mode);
+
+        // Close a recording without finalizing it, such as in a child process
+        //  that inherited it and must not write into its parent's file...
+        void Abandon();
+
+        // Get the mode the journal was opened in...
+        ModeType GetMode() const { return m_Mode; }
+
+        // Get the number of words recorded or replayed so far. For a
+        //  recording, only those up to the first that could not be stored...
+        uint64_t GetWords() const;
+
+        // Check if a journal being replayed has served every word it holds...
+        bool IsExhausted() const
+            { return m_Next.load(std::memory_order_relaxed) >= m_Capacity; }
+
+        // Check if the journal was opened successfully...
+        bool IsOpen() const { return (m_File != -1); }
+
+        // Append words to a journal being recorded. The header's count covers
+        //  them by the time this returns, so a recording is replayable up to
+        //  that point even if the process dies without closing it. Thread
+        //  safe...
+        void Record(const uint64_t *Words, const size_t Count);
+
+        // Serve up to the requested number of words from a journal being
+        //  replayed, returning how many were available. Thread safe...
+        size_t Replay(uint64_t *Words, const size_t Count);
+
+        // Flush and close the journal...
+       ~RandomJournal();
+
+    // Protected attributes...
+    protected:
+
+        // On disk header preceding the journalled words...
+        struct Header
+        {
+            char        Magic[8];
+            uint32_t    Version;
+            uint32_t    WordSize;
+            uint64_t    Words;
+            uint64_t    Reserved;
+        };
+
+        // Size of each file mapping used while recording. A multiple of the
+        //  page size and of the word size so words never straddle mappings...
+        static const size_t ChunkBytes  = 16 * 1024 * 1024;
+
+        // Maximum number of mappings, bounding a recording to 64 GB...
+        static const size_t MaximumChunks = 4096;
+
+    // Protected methods...
+    protected:
+
+        // Raise the word count in the header of a journal being recorded to
+        //  at least the given number...
+        void CommitWords(const uint64_t Words);
+
+        // Map the given chunk of a journal being recorded, extending the file
+        //  as necessary. Returns nullptr if the journal is full...
+        uint8_t *MapChunk(const size_t Chunk);
+
+        // Note that the given word of a journal being recorded could not be
+        //  stored, so the recording ends before it...
+        void MarkMissing(const uint64_t Word);
+
+    // Private methods...
+    private:
+
+        // Forbid copy constructor and assignment...
+        RandomJournal(const RandomJournal &);
+        RandomJournal &operator=(const RandomJournal &);
+
+    // Protected attributes...
+    protected:
+
+        // Whether we are recording or replaying...
+        const ModeType          m_Mode;
+
+        // Journal file descriptor, or -1 if not open...
+        int                     m_File;
+
+        // Index of the next word to be recorded or replayed...
+        std::atomic<uint64_t>   m_Next;
+
+        // Index of the first word reserved for recording that could not be
+        //  stored, if any...
+        std::atomic<uint64_t>   m_Missing;
+
+        // Number of words available for replay...
+        uint64_t                m_Capacity;
+
+        // Writable mappings of each chunk while recording...
+        std::atomic<uint8_t *>  m_Chunks[MaximumChunks];
+
+        // Read only mapping of the whole file while replaying...
+        const uint8_t          *m_Mapping;
+        size_t                  m_MappingBytes;
+
+        // Serializes mapping of new chunks while recording...
+        uv_mutex_t              m_Mutex;
+};
+
+#endif
+
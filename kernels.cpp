@@ -0,0 +1,176 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Includes...
+
+    // Ours...
+    #include "kernels.h"
+    #include "siphash.h"
+
+// Instruction sets each specialized kernel may be compiled with. We never
+//  pass these on the command line, since then the whole module would fault on
+//  older hosts. Instead only the functions below are compiled for them and
+//  are only called after CPUID said it was safe. Every extension listed here
+//  must also be checked for when the kernels are selected...
+#define KERNEL_TARGET_AVX2      __attribute__((target("avx2,bmi2")))
+#define KERNEL_TARGET_AVX512    __attribute__((target("avx2,bmi2,avx512f,avx512dq,avx512vl,avx512bw")))
+
+// Number of words processed together per iteration at each level, matching
+//  the vector width so the compiler can keep whole vectors in flight...
+template <KernelLevel Level> struct KernelLanes { static const size_t Value = 4; };
+template <> struct KernelLanes<KernelAvx2> { static const size_t Value = 8; };
+template <> struct KernelLanes<KernelAvx512> { static const size_t Value = 16; };
+
+// Map each word into [Lower, Lower + Range) by multiply-shift...
+template <KernelLevel Level>
+static inline __attribute__((always_inline)) bool ReduceRangeBody(
+    const uint32_t *Words,
+    int32_t        *Output,
+    const size_t    Count,
+    const uint32_t  Range,
+    const uint32_t  Threshold,
+    const int32_t   Lower)
+{
+    // Lanes per iteration...
+    const size_t Lanes = KernelLanes<Level>::Value;
+
+    // Whether any word needs to be redrawn...
+    uint32_t Rejected = 0;
+
+    // Whole groups of lanes...
+    size_t Index = 0;
+    for(; Index + Lanes <= Count; Index += Lanes)
+    {
+        for(size_t Lane = 0; Lane < Lanes; ++Lane)
+        {
+            const uint64_t Product =
+                static_cast<uint64_t>(Words[Index + Lane]) * Range;
+            Output[Index + Lane] = static_cast<int32_t>(
+                static_cast<uint32_t>(Product >> 32) +
+                static_cast<uint32_t>(Lower));
+            Rejected |= (static_cast<uint32_t>(Product) < Threshold);
+        }
+    }
+
+    // Remainder...
+    for(; Index < Count; ++Index)
+    {
+        const uint64_t Product = static_cast<uint64_t>(Words[Index]) * Range;
+        Output[Index] = static_cast<int32_t>(
+            static_cast<uint32_t>(Product >> 32) + static_cast<uint32_t>(Lower));
+        Rejected |= (static_cast<uint32_t>(Product) < Threshold);
+    }
+
+    // Done...
+    return (Rejected != 0);
+}
+
+// Convert each word to a double uniformly distributed in [0, 1)...
+template <KernelLevel Level>
+static inline __attribute__((always_inline)) void ToDoubleBody(
+    const uint64_t *Words, double *Output, const size_t Count)
+{
+    // One unit in the last place of a double in [0, 1)...
+    const double Epsilon = 1.0 / 9007199254740992.0;
+
+    // Convert the upper 53 bits of each word...
+    for(size_t Index = 0; Index < Count; ++Index)
+        Output[Index] = static_cast<double>(Words[Index] >> 11) * Epsilon;
+}
+
+// SipHash-2-4 each word along with its position in the stream...
+template <KernelLevel Level>
+static inline __attribute__((always_inline)) void ExtractBody(
+    const uint64_t  Key[2],
+    const uint64_t *Input,
+    uint64_t       *Output,
+    const size_t    Count,
+    const uint64_t  Counter)
+{
+    // Copy the key locally so the compiler knows it can't alias the output...
+    const uint64_t LocalKey[2] = { Key[0], Key[1] };
+
+    // Lanes are independent of each other...
+    for(size_t Index = 0; Index < Count; ++Index)
+    {
+        const uint64_t Message[2] = { Input[Index], Counter + Index };
+        Output[Index] = SipHash(LocalKey, Message, 2);
+    }
+}
+
+// Baseline kernels...
+static bool ReduceRangeBaseline(
+    const uint32_t *Words, int32_t *Output, const size_t Count,
+    const uint32_t Range, const uint32_t Threshold, const int32_t Lower)
+{
+    return ReduceRangeBody<KernelBaseline>(
+        Words, Output, Count, Range, Threshold, Lower);
+}
+static void ToDoubleBaseline(
+    const uint64_t *Words, double *Output, const size_t Count)
+{
+    ToDoubleBody<KernelBaseline>(Words, Output, Count);
+}
+static void ExtractBaseline(
+    const uint64_t Key[2], const uint64_t *Input, uint64_t *Output,
+    const size_t Count, const uint64_t Counter)
+{
+    ExtractBody<KernelBaseline>(Key, Input, Output, Count, Counter);
+}
+
+// AVX2 kernels...
+KERNEL_TARGET_AVX2 static bool ReduceRangeAvx2(
+    const uint32_t *Words, int32_t *Output, const size_t Count,
+    const uint32_t Range, const uint32_t Threshold, const int32_t Lower)
+{
+    return ReduceRangeBody<KernelAvx2>(
+        Words, Output, Count, Range, Threshold, Lower);
+}
+KERNEL_TARGET_AVX2 static void ToDoubleAvx2(
+    const uint64_t *Words, double *Output, const size_t Count)
+{
+    ToDoubleBody<KernelAvx2>(Words, Output, Count);
+}
+KERNEL_TARGET_AVX2 static void ExtractAvx2(
+    const uint64_t Key[2], const uint64_t *Input, uint64_t *Output,
+    const size_t Count, const uint64_t Counter)
+{
+    ExtractBody<KernelAvx2>(Key, Input, Output, Count, Counter);
+}
+
+// AVX-512 kernels...
+KERNEL_TARGET_AVX512 static bool ReduceRangeAvx512(
+    const uint32_t *Words, int32_t *Output, const size_t Count,
+    const uint32_t Range, const uint32_t Threshold, const int32_t Lower)
+{
+    return ReduceRangeBody<KernelAvx512>(
+        Words, Output, Count, Range, Threshold, Lower);
+}
+KERNEL_TARGET_AVX512 static void ToDoubleAvx512(
+    const uint64_t *Words, double *Output, const size_t Count)
+{
+    ToDoubleBody<KernelAvx512>(Words, Output, Count);
+}
+KERNEL_TARGET_AVX512 static void ExtractAvx512(
+    const uint64_t Key[2], const uint64_t *Input, uint64_t *Output,
+    const size_t Count, const uint64_t Counter)
+{
+    ExtractBody<KernelAvx512>(Key, Input, Output, Count, Counter);
+}
+
+// Tables for each level...
+static const KernelTable KernelTables[] =
+{
+    { KernelBaseline,   "baseline", ReduceRangeBaseline,    ToDoubleBaseline,   ExtractBaseline },
+    { KernelAvx2,       "avx2",     ReduceRangeAvx2,        ToDoubleAvx2,       ExtractAvx2     },
+    { KernelAvx512,     "avx512",   ReduceRangeAvx512,      ToDoubleAvx512,     ExtractAvx512   }
+};
+
+// Get the kernels compiled for the given instruction set level...
+const KernelTable &GetKernelTable(const KernelLevel Level)
+{
+    return KernelTables[Level];
+}
+
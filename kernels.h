@@ -0,0 +1,68 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Multiple include protection...
+#ifndef _KERNELS_H_
+#define _KERNELS_H_
+
+// Includes...
+
+    // Standard C++...
+#ifdef __APPLE__
+    #include <tr1/cstdint>
+#else
+    #include <cstdint>
+#endif
+    #include <cstddef>
+
+// Instruction set levels we carry specialized kernels for...
+typedef enum
+{
+    KernelBaseline  = 0,    /* Any x86-64, SSE2 only. */
+    KernelAvx2,             /* Haswell and later. */
+    KernelAvx512            /* Skylake-SP and later, with DQ and VL. */
+
+}KernelLevel;
+
+// Bulk kernels compiled for one instruction set level. Each is generated from
+//  the same template and differs only in what the compiler was allowed to
+//  vectorize with, so all levels produce identical output...
+struct KernelTable
+{
+    // Level this table was compiled for and its name...
+    KernelLevel     Level;
+    const char     *Name;
+
+    // Map each word into [Lower, Lower + Range) by multiply-shift. Returns
+    //  true if any word landed below Threshold in the low half of its
+    //  product, in which case the caller must redraw those words to stay
+    //  unbiased...
+    bool (*ReduceRange)(
+        const uint32_t *Words,
+        int32_t        *Output,
+        const size_t    Count,
+        const uint32_t  Range,
+        const uint32_t  Threshold,
+        const int32_t   Lower);
+
+    // Convert each word to a double uniformly distributed in [0, 1) from its
+    //  upper 53 bits...
+    void (*ToDouble)(const uint64_t *Words, double *Output, const size_t Count);
+
+    // SipHash-2-4 each word along with its position in the stream, starting
+    //  at Counter, under the given key...
+    void (*Extract)(
+        const uint64_t  Key[2],
+        const uint64_t *Input,
+        uint64_t       *Output,
+        const size_t    Count,
+        const uint64_t  Counter);
+};
+
+// Get the kernels compiled for the given instruction set level...
+const KernelTable &GetKernelTable(const KernelLevel Level);
+
+#endif
+
@@ -0,0 +1,109 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Measures how throughput scales with the number of threads drawing from the
+//  generator at once. Each thread count runs in its own child process with a
+//  libuv threadpool of that size, kept saturated with bulk fills...
+//
+//  Usage: node node-rng-bench-scaling.js [source] [seconds]
+
+// Try to load the module...
+var rng = require('./build/Release/rng');
+var child_process = require('child_process');
+
+// Words filled per request...
+var wordsPerRequest = 65536;
+
+// Child process measuring one thread count...
+if(process.argv[2] === '--child')
+{
+    // Settings from our parent...
+    var source      = process.argv[3];
+    var seconds     = Number(process.argv[4]);
+    var threads     = Number(process.env.UV_THREADPOOL_SIZE);
+
+    // Select the source under test...
+    rng.setSource(source);
+
+    // Keep every thread busy with a request or two queued behind it...
+    var words       = 0;
+    var started     = process.hrtime();
+    var finished    = false;
+    var inFlight    = 0;
+
+    // Issue another fill...
+    var issue = function(array)
+    {
+        ++inFlight;
+        rng.fillRandomAsync(array, function(err, result) {
+
+            // Count it...
+            --inFlight;
+            words += result.length;
+
+            // Check if time is up...
+            var elapsed = process.hrtime(started);
+            if(elapsed[0] + elapsed[1] / 1e9 >= seconds)
+                finished = true;
+
+            // Keep going...
+            if(!finished)
+                issue(result);
+
+            // Report once everything has drained...
+            else if(inFlight === 0)
+            {
+                elapsed = process.hrtime(started);
+                console.log(JSON.stringify({
+                    threads: threads,
+                    wordsPerSecond: words / (elapsed[0] + elapsed[1] / 1e9)
+                }));
+            }
+        });
+    };
+
+    // Start...
+    for(var i = 0; i < threads * 2; ++i)
+        issue(new Uint32Array(wordsPerRequest));
+}
+
+// Parent process running each thread count in turn...
+else
+{
+    // Settings...
+    var source  = process.argv[2] || 'rdrand';
+    var seconds = process.argv[3] || 2;
+
+    console.log("Source:", source);
+    console.log("Threads\tMwords/s\tSpeedup\tEfficiency");
+
+    // Double the number of threads each time...
+    var baseline = 0;
+    for(var threads = 1; threads <= 64; threads *= 2)
+    {
+        // Threadpool size can only be set before it starts, so use a fresh
+        //  process for each...
+        var env = Object.create(process.env);
+        env.UV_THREADPOOL_SIZE = threads;
+        var output = child_process.execFileSync(
+            process.execPath,
+            [__filename, '--child', source, seconds],
+            { env: env });
+        var result = JSON.parse(output.toString());
+
+        // First run is what the rest are compared against...
+        if(!baseline)
+            baseline = result.wordsPerSecond;
+
+        // Show...
+        var speedup = result.wordsPerSecond / baseline;
+        console.log(
+            threads + "\t" +
+            (result.wordsPerSecond / 1e6).toFixed(2) + "\t\t" +
+            speedup.toFixed(2) + "\t" +
+            (100 * speedup / threads).toFixed(0) + "%");
+    }
+}
+
@@ -0,0 +1,68 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Measures cold start latency, from require() until the first random number
+//  is in hand. Every run is a fresh child process so nothing is warm...
+//
+//  Usage: node node-rng-bench-startup.js [runs]
+
+// Child process measuring one cold start...
+if(process.argv[2] === '--child')
+{
+    // Load the module...
+    var started = process.hrtime();
+    var rng = require('./index.js');
+    var loaded = process.hrtime(started);
+
+    // Draw once...
+    rng.getRandom();
+    var drawn = process.hrtime(started);
+
+    // Report in milliseconds...
+    console.log(JSON.stringify({
+        require: loaded[0] * 1e3 + loaded[1] / 1e6,
+        first: drawn[0] * 1e3 + drawn[1] / 1e6
+    }));
+}
+
+// Parent process running each cold start in turn...
+else
+{
+    var child_process = require('child_process');
+
+    // Settings...
+    var runs = Number(process.argv[2]) || 50;
+
+    // Run...
+    var requires = [];
+    var firsts = [];
+    for(var run = 0; run < runs; ++run)
+    {
+        var output = child_process.execFileSync(
+            process.execPath, [__filename, '--child']);
+        var result = JSON.parse(output.toString());
+        requires.push(result.require);
+        firsts.push(result.first);
+    }
+
+    // Get the given percentile of a set of samples...
+    var percentile = function(samples, fraction)
+    {
+        var sorted = samples.slice().sort(function(a, b) { return a - b; });
+        return sorted[Math.min(sorted.length - 1, Math.floor(fraction * sorted.length))];
+    };
+
+    // Show...
+    console.log("Runs:", runs);
+    console.log("Milliseconds\tMedian\tp90");
+    console.log(
+        "require\t\t" +
+        percentile(requires, 0.5).toFixed(3) + "\t" +
+        percentile(requires, 0.9).toFixed(3));
+    console.log(
+        "first random\t" +
+        percentile(firsts, 0.5).toFixed(3) + "\t" +
+        percentile(firsts, 0.9).toFixed(3));
+}
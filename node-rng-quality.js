@@ -0,0 +1,96 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Streams several gigabytes of output from each of the generator's modes
+//  through a battery of statistical tests, spread across every core. Exits
+//  with a non-zero status if any test fails...
+//
+//  Usage: node node-rng-quality.js [mode[=bytes] ...] [--threads n]
+
+// Try to load the module...
+var selftest = require('./build/Release/rng_selftest');
+var os = require('os');
+
+// Modes tested by default and how many bytes of each. RDSEED is far slower
+//  than the rest so gets less...
+var defaults = {
+    rdrand: 4 * 1024 * 1024 * 1024,
+    rdseed: 256 * 1024 * 1024,
+    mixed:  4 * 1024 * 1024 * 1024,
+    range:  1024 * 1024 * 1024,
+    'range-single': 256 * 1024 * 1024,
+    float:  1024 * 1024 * 1024
+};
+
+// Parse command line...
+var threads = os.cpus().length;
+var modes   = [];
+for(var i = 2; i < process.argv.length; ++i)
+{
+    // Thread count...
+    if(process.argv[i] === '--threads')
+    {
+        threads = Number(process.argv[++i]);
+        continue;
+    }
+
+    // Mode with an optional size...
+    var parts = process.argv[i].split('=');
+    modes.push({
+        name: parts[0],
+        bytes: parts[1] ? Number(parts[1]) : defaults[parts[0]]
+    });
+}
+
+// Everything by default...
+if(!modes.length)
+{
+    for(var name in defaults)
+        modes.push({ name: name, bytes: defaults[name] });
+}
+
+// Run each battery in turn...
+var failures = 0;
+modes.forEach(function(mode) {
+
+    // Run. Raw sources this host lacks are skipped, but anything else that
+    //  stops a battery from running, such as an unknown mode or a bad size,
+    //  fails it...
+    var started = process.hrtime();
+    var results;
+    try
+    {
+        results = selftest.runQualityBattery(mode.name, mode.bytes, threads);
+    }
+    catch(error)
+    {
+        if(error.message === "source is not supported by this host")
+            console.log(mode.name + ": " + error.message + ", skipped\n");
+        else
+        {
+            console.log(mode.name + ": FAIL  " + error.message + "\n");
+            ++failures;
+        }
+        return;
+    }
+    var elapsed = process.hrtime(started);
+    var seconds = elapsed[0] + elapsed[1] / 1e9;
+
+    // Show...
+    console.log(mode.name + ": " + (mode.bytes / 1048576).toFixed(0) +
+        " MiB in " + seconds.toFixed(1) + " s on " + threads + " threads");
+    results.forEach(function(result) {
+        console.log("    " + (result.passed ? "pass" : "FAIL") + "  " +
+            result.name + "\t" + result.statistic.toFixed(4) +
+            "\tp=" + result.pValue.toFixed(6));
+        if(!result.passed)
+            ++failures;
+    });
+    console.log();
+});
+
+// Report...
+console.log(failures ? (failures + " test(s) failed") : "All tests passed");
+process.exit(failures ? 1 : 0);
@@ -0,0 +1,352 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Self tests, built as a separate module that is never shipped so that long
+//  running checks stay out of the production module's exports...
+
+// Includes...
+
+    // Our headers...
+    #include "quality.h"
+    #include "random.h"
+    #include "selftest.h"
+
+    // Node.js...
+    #include <node.h>
+
+    // Standard C++...
+    #include <algorithm>
+    #include <cstring>
+    #include <string>
+
+// Import namespaces...
+
+    // Standard C++...
+    using namespace std;
+
+    // V8...
+    using v8::Array;
+    using v8::Boolean;
+    using v8::Exception;
+    using v8::FunctionCallbackInfo;
+    using v8::Isolate;
+    using v8::Local;
+    using v8::Number;
+    using v8::Object;
+    using v8::String;
+    using v8::Value;
+
+// Local declarations...
+namespace selftest
+{
+    // Names by which JavaScript selects which output a quality battery is run
+    //  against...
+    static const struct
+    {
+        const char                         *Name;
+        QualityMode                         Mode;
+        RandomNumberGenerator::SourceType   Source;
+    }
+    QualityNames[] =
+    {
+        { "rdrand", QualityRaw,     RandomNumberGenerator::IntelSecureKey },
+        { "rdseed", QualityRaw,     RandomNumberGenerator::IntelSecureKeySeed },
+        { "mixed",  QualityRaw,     RandomNumberGenerator::Mixed },
+        { "range",  QualityRange,   RandomNumberGenerator::None },
+        { "range-single", QualityRangeSingle, RandomNumberGenerator::None },
+        { "float",  QualityFloat,   RandomNumberGenerator::None }
+    };
+
+    // Smallest p-value a test may produce and still be considered passed...
+    static const double QualityThreshold = 1e-4;
+
+    // Module is initializing...
+    static void OnLoad(Local<Object> Exports);
+
+    // Module is cleaning up...
+    static void OnUnload(void *);
+}
+
+// All methods exported, unless marked static, to the VM...
+namespace selftest {
+
+// Callback implementing JavaScript selftest.checkBernoulli()...
+void checkBernoulli(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Run the check...
+    string Failure;
+    if(!CheckBernoulli(RandomNumberGenerator::GetInstance(), Failure))
+    {
+        // Throw a JavaScript exception within the virtual machine...
+        isolate->ThrowException(Exception::Error(
+        String::NewFromUtf8(isolate, Failure.c_str())));
+        return;
+    }
+
+    // Passed...
+    Arguments.GetReturnValue().Set(true);
+}
+
+// Callback implementing JavaScript selftest.checkJournalCrash(directory)...
+void checkJournalCrash(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Validate arguments...
+
+        // Insufficient in number...
+        if(Arguments.Length() != 1)
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected one argument")));
+            return;
+        }
+
+        // Incorrect type...
+        if(!Arguments[0]->IsString())
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected a directory")));
+            return;
+        }
+
+        // Get arguments...
+        const String::Utf8Value Directory(Arguments[0]);
+
+    // Run the check...
+    string Failure;
+    if(!CheckJournalCrash(RandomNumberGenerator::GetInstance(), *Directory, Failure))
+    {
+        // Throw a JavaScript exception within the virtual machine...
+        isolate->ThrowException(Exception::Error(
+        String::NewFromUtf8(isolate, Failure.c_str())));
+        return;
+    }
+
+    // Passed...
+    Arguments.GetReturnValue().Set(true);
+}
+
+// Callback implementing JavaScript selftest.checkKernels()...
+void checkKernels(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Run the check...
+    string Failure;
+    if(!CheckKernels(Failure))
+    {
+        // Throw a JavaScript exception within the virtual machine...
+        isolate->ThrowException(Exception::Error(
+        String::NewFromUtf8(isolate, Failure.c_str())));
+        return;
+    }
+
+    // Passed...
+    Arguments.GetReturnValue().Set(true);
+}
+
+// Callback implementing JavaScript selftest.checkPrimes()...
+void checkPrimes(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Run the check...
+    string Failure;
+    if(!CheckPrimes(RandomNumberGenerator::GetInstance(), Failure))
+    {
+        // Throw a JavaScript exception within the virtual machine...
+        isolate->ThrowException(Exception::Error(
+        String::NewFromUtf8(isolate, Failure.c_str())));
+        return;
+    }
+
+    // Passed...
+    Arguments.GetReturnValue().Set(true);
+}
+
+// Callback implementing JavaScript selftest.checkFork(directory)...
+void checkFork(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Validate arguments...
+
+        // Insufficient in number...
+        if(Arguments.Length() != 1)
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected one argument")));
+            return;
+        }
+
+        // Incorrect type...
+        if(!Arguments[0]->IsString())
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected a directory")));
+            return;
+        }
+
+        // Get arguments...
+        const String::Utf8Value Directory(Arguments[0]);
+
+    // Run the check...
+    string Failure;
+    if(!CheckFork(RandomNumberGenerator::GetInstance(), *Directory, Failure))
+    {
+        // Throw a JavaScript exception within the virtual machine...
+        isolate->ThrowException(Exception::Error(
+        String::NewFromUtf8(isolate, Failure.c_str())));
+        return;
+    }
+
+    // Passed...
+    Arguments.GetReturnValue().Set(true);
+}
+
+// Callback implementing JavaScript selftest.runQualityBattery(mode, bytes,
+//  threads)...
+void runQualityBattery(const FunctionCallbackInfo<Value> &Arguments)
+{
+    // Retrieve virtual machine state...
+    Isolate *isolate = Arguments.GetIsolate();
+
+    // Validate arguments...
+
+        // Insufficient in number...
+        if(Arguments.Length() < 2 || Arguments.Length() > 3)
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected two or three arguments")));
+            return;
+        }
+
+        // Incorrect types...
+        if(!Arguments[0]->IsString() || !Arguments[1]->IsNumber() ||
+           (Arguments.Length() == 3 && !Arguments[2]->IsUint32()))
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "expected a mode name, a number of bytes, and optionally a number of threads")));
+            return;
+        }
+
+        // Get arguments...
+        const String::Utf8Value Name(Arguments[0]);
+        const double Bytes      = Arguments[1]->NumberValue();
+        const unsigned Threads  = (Arguments.Length() == 3)
+            ? Arguments[2]->ToUint32()->Value() : 1;
+
+        // Need at least one value per thread...
+        if(!(Bytes >= 8.0 * max(1U, Threads)))
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::RangeError(
+            String::NewFromUtf8(isolate, "too few bytes for the number of threads")));
+            return;
+        }
+
+        // Find the named mode...
+        size_t Index = 0;
+        const size_t Modes = sizeof(QualityNames) / sizeof(QualityNames[0]);
+        while(Index < Modes && ::strcmp(QualityNames[Index].Name, *Name) != 0)
+            ++Index;
+
+        // Unknown...
+        if(Index == Modes)
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::TypeError(
+            String::NewFromUtf8(isolate, "unknown quality mode")));
+            return;
+        }
+
+    // Get the random number generator...
+    RandomNumberGenerator &Generator = RandomNumberGenerator::GetInstance();
+
+        // Raw sources must be supported by this host...
+        if(QualityNames[Index].Mode == QualityRaw &&
+           !Generator.IsSourceSupported(QualityNames[Index].Source))
+        {
+            // Throw a JavaScript exception within the virtual machine...
+            isolate->ThrowException(Exception::Error(
+            String::NewFromUtf8(isolate, "source is not supported by this host")));
+            return;
+        }
+
+    // Run the battery. This blocks until it is done...
+    vector<QualityResult> Results;
+    RunQualityBattery(
+        Generator,
+        QualityNames[Index].Mode,
+        QualityNames[Index].Source,
+        static_cast<uint64_t>(Bytes),
+        Threads,
+        Results);
+
+    // Pack each result into an object for the caller...
+    Local<Array> ReturnValue = Array::New(isolate, Results.size());
+    for(size_t Result = 0; Result < Results.size(); ++Result)
+    {
+        Local<Object> Entry = Object::New(isolate);
+        Entry->Set(String::NewFromUtf8(isolate, "name"),
+            String::NewFromUtf8(isolate, Results[Result].Name.c_str()));
+        Entry->Set(String::NewFromUtf8(isolate, "statistic"),
+            Number::New(isolate, Results[Result].Statistic));
+        Entry->Set(String::NewFromUtf8(isolate, "pValue"),
+            Number::New(isolate, Results[Result].PValue));
+        Entry->Set(String::NewFromUtf8(isolate, "passed"),
+            Boolean::New(isolate,
+                Results[Result].PValue >= QualityThreshold));
+        ReturnValue->Set(static_cast<uint32_t>(Result), Entry);
+    }
+
+    // Pass back to caller...
+    Arguments.GetReturnValue().Set(ReturnValue);
+}
+
+// Module is initializing...
+static void OnLoad(Local<Object> Exports)
+{
+    // Initialize random number generator...
+    RandomNumberGenerator::CreateSingleton();
+
+    // Export our JavaScript method callbacks...
+    NODE_SET_METHOD(Exports, "checkBernoulli",      checkBernoulli);
+    NODE_SET_METHOD(Exports, "checkFork",           checkFork);
+    NODE_SET_METHOD(Exports, "checkJournalCrash",   checkJournalCrash);
+    NODE_SET_METHOD(Exports, "checkKernels",        checkKernels);
+    NODE_SET_METHOD(Exports, "checkPrimes",         checkPrimes);
+    NODE_SET_METHOD(Exports, "runQualityBattery",   runQualityBattery);
+
+    // On de-initialization...
+    node::AtExit(OnUnload);
+}
+
+// Module is cleaning up...
+static void OnUnload(void *)
+{
+    // Cleanup the random number generator singleton instance...
+    RandomNumberGenerator::DestroySingleton();
+}
+
+}
+
+// Export our initialization function...
+NODE_MODULE(rng_selftest, selftest::OnLoad)
+
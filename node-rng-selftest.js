@@ -0,0 +1,63 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Runs every self test in the separate self test module, which is built
+//  alongside the module but never published. Exits with a non-zero status if
+//  any check fails. --debug runs them against the unoptimized Debug build
+//  instead, which also catches symbols that only optimization hid...
+//
+//  Usage: node node-rng-selftest.js [--debug] [check ...]
+
+// Which build to test...
+var args = process.argv.slice(2);
+var build = 'Release';
+if(args[0] === '--debug')
+{
+    build = 'Debug';
+    args.shift();
+}
+
+// Try to load the module...
+var selftest = require('./build/' + build + '/rng_selftest');
+var os = require('os');
+
+// Every check by name...
+var checks = {
+    bernoulli: function() { return selftest.checkBernoulli(); },
+    fork: function() { return selftest.checkFork(os.tmpdir()); },
+    journal: function() { return selftest.checkJournalCrash(os.tmpdir()); },
+    kernels: function() { return selftest.checkKernels(); },
+    primes: function() { return selftest.checkPrimes(); }
+};
+
+// Run the named checks, or all of them...
+var names = args.length ? args : Object.keys(checks);
+var failures = 0;
+names.forEach(function(name) {
+
+    // Unknown...
+    if(!checks[name])
+    {
+        console.log("FAIL  " + name + ": no such check");
+        ++failures;
+        return;
+    }
+
+    // Run...
+    try
+    {
+        checks[name]();
+        console.log("pass  " + name);
+    }
+    catch(error)
+    {
+        console.log("FAIL  " + name + ": " + error.message);
+        ++failures;
+    }
+});
+
+// Report...
+console.log(failures ? (failures + " check(s) failed") : "All checks passed");
+process.exit(failures ? 1 : 0);
@@ -29,17 +29,36 @@
 // Module is initializing...
 void OnLoad(Local<Object> Exports)
 {
-    // Initialize random number generator...
+    // Initialize random number generator. This only sets up locks, leaving
+    //  probing the processor and allocating locked memory for first use...
     RandomNumberGenerator::CreateSingleton();
 
     // Export our JavaScript method callbacks...
     NODE_SET_METHOD(Exports, "isAvailable",         rng::isAvailable);
+    NODE_SET_METHOD(Exports, "fillBernoulli",       rng::fillBernoulli);
+    NODE_SET_METHOD(Exports, "fillRandom",          rng::fillRandom);
+    NODE_SET_METHOD(Exports, "fillRandomAsync",     rng::fillRandomAsync);
+    NODE_SET_METHOD(Exports, "fillRandomFloat",     rng::fillRandomFloat);
+    NODE_SET_METHOD(Exports, "fillRandomRange",     rng::fillRandomRange);
+    NODE_SET_METHOD(Exports, "getCapabilities",     rng::getCapabilities);
     NODE_SET_METHOD(Exports, "getCorrections",      rng::getCorrections);
+    NODE_SET_METHOD(Exports, "getKernels",          rng::getKernels);
     NODE_SET_METHOD(Exports, "getRandom",           rng::getRandom);
     NODE_SET_METHOD(Exports, "getRandomAsync",      rng::getRandomAsync);
+    NODE_SET_METHOD(Exports, "getRandomBelow",      rng::getRandomBelow);
+    NODE_SET_METHOD(Exports, "getRandomBits",       rng::getRandomBits);
+    NODE_SET_METHOD(Exports, "getRandomPrime",      rng::getRandomPrime);
+    NODE_SET_METHOD(Exports, "getRandomPrimeAsync", rng::getRandomPrimeAsync);
     NODE_SET_METHOD(Exports, "getRandomRange",      rng::getRandomRange);
     NODE_SET_METHOD(Exports, "getRandomRangeAsync", rng::getRandomRangeAsync);
+    NODE_SET_METHOD(Exports, "getSource",           rng::getSource);
+    NODE_SET_METHOD(Exports, "getSourceStatistics", rng::getSourceStatistics);
     NODE_SET_METHOD(Exports, "getVersion",          rng::getVersion);
+    NODE_SET_METHOD(Exports, "randomBits",          rng::getRandomBits);
+    NODE_SET_METHOD(Exports, "recordJournal",       rng::recordJournal);
+    NODE_SET_METHOD(Exports, "replayJournal",       rng::replayJournal);
+    NODE_SET_METHOD(Exports, "setSource",           rng::setSource);
+    NODE_SET_METHOD(Exports, "stopJournal",         rng::stopJournal);
 
     // On de-initialization...
     node::AtExit(OnUnload);
@@ -48,7 +67,11 @@ void OnLoad(Local<Object> Exports)
 // Module is cleaning up...
 void OnUnload(void *)
 {
-    // Cleanup the random number generator singleton instance...
+    // Stop the worker serving asynchronous draws...
+    rng::ShutdownRequestQueue();
+
+    // Cleanup the random number generator singleton instance. This zeroes
+    //  every key and buffered word it held before releasing the memory...
     RandomNumberGenerator::DestroySingleton();
 }
 
@@ -0,0 +1,402 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Includes...
+
+    // Ours...
+    #include "quality.h"
+
+    // Libuv...
+    #include <uv.h>
+
+    // Standard C++...
+    #include <algorithm>
+    #include <cmath>
+    #include <cstring>
+
+// Using the standard namespace...
+using namespace std;
+
+// Values drawn from the generator at a time by each thread...
+static const size_t     QualityChunk        = 65536;
+
+// Buckets for the range and float chi-square tests. The range is deliberately
+//  not a power of two so that rejection in the range reduction is exercised...
+static const uint32_t   RangeBuckets        = 1000;
+static const uint32_t   FloatBuckets        = 1024;
+
+// Birthday spacings parameters. With 512 birthdays in a year of 2^24 days the
+//  number of repeated spacings is Poisson with a mean of two...
+static const size_t     BirthdayCount       = 512;
+static const unsigned   BirthdayDayBits     = 24;
+static const double     BirthdayLambda      = 2.0;
+static const uint64_t   BirthdayMaximumRuns = 200000;
+
+// Everything one thread tallies over its share of the stream...
+struct QualityTally
+{
+    QualityTally()
+        : Generator(nullptr),
+          Mode(QualityRaw),
+          Source(RandomNumberGenerator::None),
+          Values(0),
+          BirthdayBudget(0),
+          Bits(0),
+          Ones(0),
+          Transitions(0),
+          BirthdayRuns(0),
+          BirthdayDuplicates(0),
+          Samples(0),
+          Pairs(0),
+          Sum(0.0),
+          SumSquares(0.0),
+          SumProducts(0.0) {}
+
+    // Inputs...
+    RandomNumberGenerator              *Generator;
+    QualityMode                         Mode;
+    RandomNumberGenerator::SourceType   Source;
+    uint64_t                            Values;
+    uint64_t                            BirthdayBudget;
+
+    // Monobit and runs...
+    uint64_t                Bits;
+    uint64_t                Ones;
+    uint64_t                Transitions;
+
+    // Byte frequencies for raw output, bucket frequencies otherwise...
+    vector<uint64_t>        Histogram;
+
+    // Birthday spacings...
+    uint64_t                BirthdayRuns;
+    uint64_t                BirthdayDuplicates;
+
+    // Serial correlation of successive uniforms...
+    uint64_t                Samples;
+    uint64_t                Pairs;
+    double                  Sum;
+    double                  SumSquares;
+    double                  SumProducts;
+};
+
+// Probability of a standard normal variate at least as far from zero as the
+//  given one...
+static double TwoSidedNormal(const double Z)
+{
+    return ::erfc(::fabs(Z) / ::sqrt(2.0));
+}
+
+// Probability of a chi-square variate with the given degrees of freedom at
+//  least as large as the given one, by the Wilson-Hilferty approximation
+//  which is very accurate at the hundreds of degrees of freedom we use...
+static double UpperChiSquare(const double ChiSquare, const double Freedom)
+{
+    const double Scale  = 2.0 / (9.0 * Freedom);
+    const double Z      =
+        (::pow(ChiSquare / Freedom, 1.0 / 3.0) - (1.0 - Scale)) / ::sqrt(Scale);
+    return 0.5 * ::erfc(Z / ::sqrt(2.0));
+}
+
+// Count repeated spacings among the given birthdays...
+static uint64_t BirthdaySpacings(uint32_t *Birthdays)
+{
+    // Sort birthdays and take the spacing between each neighbouring pair...
+    sort(Birthdays, Birthdays + BirthdayCount);
+    uint32_t Spacings[BirthdayCount];
+    Spacings[0] = Birthdays[0];
+    for(size_t Index = 1; Index < BirthdayCount; ++Index)
+        Spacings[Index] = Birthdays[Index] - Birthdays[Index - 1];
+
+    // Count spacings equal to the one before them once sorted...
+    sort(Spacings, Spacings + BirthdayCount);
+    uint64_t Duplicates = 0;
+    for(size_t Index = 1; Index < BirthdayCount; ++Index)
+        Duplicates += (Spacings[Index] == Spacings[Index - 1]);
+
+    // Done...
+    return Duplicates;
+}
+
+// Fold a run of uniforms in [0, 1) into the serial correlation sums...
+static void TallySerial(
+    QualityTally &Tally, const double *Uniforms, const size_t Count, double &Previous)
+{
+    // Partial sums for this run, so precision isn't lost adding small terms
+    //  onto very large totals...
+    double Sum = 0.0, SumSquares = 0.0, SumProducts = 0.0;
+    for(size_t Index = 0; Index < Count; ++Index)
+    {
+        Sum         += Uniforms[Index];
+        SumSquares  += Uniforms[Index] * Uniforms[Index];
+        SumProducts += Previous * Uniforms[Index];
+        Previous     = Uniforms[Index];
+    }
+
+    // The very first value has no predecessor...
+    Tally.Pairs         += Count - (Tally.Samples ? 0 : 1);
+    Tally.Samples       += Count;
+    Tally.Sum           += Sum;
+    Tally.SumSquares    += SumSquares;
+    Tally.SumProducts   += SumProducts;
+}
+
+// Thread tallying its share of the stream...
+static void QualityThread(void *Argument)
+{
+    // Our share...
+    QualityTally &Tally = *static_cast<QualityTally *>(Argument);
+
+    // Buffers...
+    vector<uint64_t>    Words(QualityChunk);
+    vector<int32_t>     Ranged(QualityChunk);
+    vector<double>      Uniforms(QualityChunk * 2);
+    uint32_t            Birthdays[BirthdayCount];
+
+    // Size the histogram...
+    Tally.Histogram.assign(
+        (Tally.Mode == QualityRaw) ? 256 :
+        (Tally.Mode == QualityFloat) ? FloatBuckets : RangeBuckets, 0);
+
+    // State carried between chunks...
+    uint64_t    PreviousBit     = 0;
+    double      Previous        = 0.0;
+    bool        CorrectionDetected = false;
+
+    // Work through our share a chunk at a time...
+    for(uint64_t Done = 0; Done < Tally.Values;)
+    {
+        // How much this time...
+        const size_t Take = static_cast<size_t>(
+            min<uint64_t>(QualityChunk, Tally.Values - Done));
+
+        // Raw words...
+        if(Tally.Mode == QualityRaw)
+        {
+            // Draw...
+            Tally.Generator->FillFromSource64(
+                Tally.Source, &Words[0], Take, CorrectionDetected);
+
+            // Monobit, runs and byte frequencies...
+            uint64_t Ones = 0, Transitions = 0;
+            uint64_t *Histogram = &Tally.Histogram[0];
+            for(size_t Index = 0; Index < Take; ++Index)
+            {
+                const uint64_t Word = Words[Index];
+
+                // Ones...
+                Ones += __builtin_popcountll(Word);
+
+                // Changes between neighbouring bits, least significant
+                //  first, including the boundary with the previous word...
+                Transitions += __builtin_popcountll(
+                    (Word ^ (Word >> 1)) & 0x7fffffffffffffffULL);
+                Transitions += ((Done + Index) && ((Word & 1) != PreviousBit));
+                PreviousBit = Word >> 63;
+
+                // Bytes...
+                for(unsigned Byte = 0; Byte < 8; ++Byte)
+                    ++Histogram[(Word >> (Byte * 8)) & 0xff];
+            }
+            Tally.Bits          += Take * 64;
+            Tally.Ones          += Ones;
+            Tally.Transitions   += Transitions;
+
+            // Serial correlation of each 32-bit half...
+            for(size_t Index = 0; Index < Take; ++Index)
+            {
+                Uniforms[Index * 2]     = static_cast<uint32_t>(Words[Index]) / 4294967296.0;
+                Uniforms[Index * 2 + 1] = static_cast<uint32_t>(Words[Index] >> 32) / 4294967296.0;
+            }
+            TallySerial(Tally, &Uniforms[0], Take * 2, Previous);
+
+            // Birthday spacings, sampled from the front of each chunk until
+            //  our budget is spent...
+            if(Take >= BirthdayCount && Tally.BirthdayRuns < Tally.BirthdayBudget)
+            {
+                for(size_t Index = 0; Index < BirthdayCount; ++Index)
+                    Birthdays[Index] = static_cast<uint32_t>(
+                        Words[Index] >> (64 - BirthdayDayBits));
+                Tally.BirthdayDuplicates += BirthdaySpacings(Birthdays);
+                ++Tally.BirthdayRuns;
+            }
+        }
+
+        // Range reduced values...
+        else if(Tally.Mode != QualityFloat)
+        {
+            // Draw in bulk...
+            if(Tally.Mode == QualityRange)
+                Tally.Generator->FillRandomRange32(
+                    &Ranged[0], Take, 0, RangeBuckets - 1, CorrectionDetected);
+
+            // Draw one at a time, which reduces on a separate path...
+            else
+            {
+                for(size_t Index = 0; Index < Take; ++Index)
+                    Ranged[Index] = Tally.Generator->GetRandomRange32(
+                        0, RangeBuckets - 1, CorrectionDetected);
+            }
+
+            // Bucket frequencies, and scale to uniforms...
+            for(size_t Index = 0; Index < Take; ++Index)
+            {
+                ++Tally.Histogram[Ranged[Index]];
+                Uniforms[Index] = (Ranged[Index] + 0.5) / RangeBuckets;
+            }
+            TallySerial(Tally, &Uniforms[0], Take, Previous);
+        }
+
+        // Doubles...
+        else
+        {
+            // Draw...
+            Tally.Generator->FillRandomDouble(
+                &Uniforms[0], Take, CorrectionDetected);
+
+            // Bucket frequencies...
+            for(size_t Index = 0; Index < Take; ++Index)
+                ++Tally.Histogram[static_cast<size_t>(Uniforms[Index] * FloatBuckets)];
+            TallySerial(Tally, &Uniforms[0], Take, Previous);
+        }
+
+        // Advance...
+        Done += Take;
+    }
+
+    // Don't leave output lying around...
+  ::memset(&Words[0], 0, Words.size() * sizeof(uint64_t));
+}
+
+// Stream the given number of bytes of the generator's output through a
+//  battery of statistical tests...
+void RunQualityBattery(
+    RandomNumberGenerator                  &Generator,
+    const QualityMode                       Mode,
+    const RandomNumberGenerator::SourceType Source,
+    const uint64_t                          Bytes,
+    const unsigned                          Threads,
+    vector<QualityResult>                  &Results)
+{
+    // Number of values in the whole stream, each eight bytes except for range
+    //  reduced ones...
+    const unsigned ThreadCount  = max(1U, Threads);
+    const bool     Ranged       =
+        (Mode == QualityRange) || (Mode == QualityRangeSingle);
+    const uint64_t Values       = Bytes / (Ranged ? 4 : 8);
+
+    // Give each thread an equal share...
+    vector<QualityTally> Tallies(ThreadCount);
+    for(unsigned Thread = 0; Thread < ThreadCount; ++Thread)
+    {
+        QualityTally &Tally     = Tallies[Thread];
+        Tally.Generator         = &Generator;
+        Tally.Mode              = Mode;
+        Tally.Source            = Source;
+        Tally.Values            = Values / ThreadCount +
+                                  ((Thread == 0) ? Values % ThreadCount : 0);
+        Tally.BirthdayBudget    = BirthdayMaximumRuns / ThreadCount;
+    }
+
+    // Run them all...
+    vector<uv_thread_t> Handles(ThreadCount);
+    for(unsigned Thread = 0; Thread < ThreadCount; ++Thread)
+      ::uv_thread_create(&Handles[Thread], QualityThread, &Tallies[Thread]);
+    for(unsigned Thread = 0; Thread < ThreadCount; ++Thread)
+      ::uv_thread_join(&Handles[Thread]);
+
+    // Combine...
+    QualityTally Total;
+    Total.Histogram.assign(Tallies[0].Histogram.size(), 0);
+    for(unsigned Thread = 0; Thread < ThreadCount; ++Thread)
+    {
+        const QualityTally &Tally = Tallies[Thread];
+        Total.Bits                  += Tally.Bits;
+        Total.Ones                  += Tally.Ones;
+        Total.Transitions           += Tally.Transitions;
+        Total.BirthdayRuns          += Tally.BirthdayRuns;
+        Total.BirthdayDuplicates    += Tally.BirthdayDuplicates;
+        Total.Samples               += Tally.Samples;
+        Total.Pairs                 += Tally.Pairs;
+        Total.Sum                   += Tally.Sum;
+        Total.SumSquares            += Tally.SumSquares;
+        Total.SumProducts           += Tally.SumProducts;
+        for(size_t Bucket = 0; Bucket < Tally.Histogram.size(); ++Bucket)
+            Total.Histogram[Bucket] += Tally.Histogram[Bucket];
+    }
+
+    // Storage for each result...
+    QualityResult Result;
+
+    // Bit level tests only make sense on raw output...
+    if(Total.Bits)
+    {
+        // Monobit: ones and zeros should balance...
+        const double Bits   = static_cast<double>(Total.Bits);
+        const double Ones   = static_cast<double>(Total.Ones);
+        Result.Name         = "monobit";
+        Result.Statistic    = (2.0 * Ones - Bits) / ::sqrt(Bits);
+        Result.PValue       = TwoSidedNormal(Result.Statistic);
+        Results.push_back(Result);
+
+        // Runs: bits should change as often as chance dictates...
+        const double Proportion = Ones / Bits;
+        const double Expected   = 2.0 * Bits * Proportion * (1.0 - Proportion);
+        const double Runs       = static_cast<double>(Total.Transitions) + 1.0;
+        Result.Name             = "runs";
+        Result.Statistic        = (Runs - Expected) /
+            (2.0 * ::sqrt(2.0 * Bits) * Proportion * (1.0 - Proportion));
+        Result.PValue           = TwoSidedNormal(Result.Statistic * ::sqrt(2.0));
+        Results.push_back(Result);
+    }
+
+    // Chi-square over byte or bucket frequencies...
+    {
+        // Expected count in each...
+        uint64_t Observations = 0;
+        for(size_t Bucket = 0; Bucket < Total.Histogram.size(); ++Bucket)
+            Observations += Total.Histogram[Bucket];
+        const double Expected =
+            static_cast<double>(Observations) / Total.Histogram.size();
+
+        // Sum squared deviations...
+        double ChiSquare = 0.0;
+        for(size_t Bucket = 0; Bucket < Total.Histogram.size(); ++Bucket)
+        {
+            const double Deviation = Total.Histogram[Bucket] - Expected;
+            ChiSquare += Deviation * Deviation / Expected;
+        }
+
+        // Store...
+        Result.Name         = (Mode == QualityRaw) ? "chi-square bytes" : "chi-square buckets";
+        Result.Statistic    = ChiSquare;
+        Result.PValue       = UpperChiSquare(ChiSquare, Total.Histogram.size() - 1.0);
+        Results.push_back(Result);
+    }
+
+    // Birthday spacings: repeated spacings should be Poisson...
+    if(Total.BirthdayRuns)
+    {
+        const double Mean   = BirthdayLambda * Total.BirthdayRuns;
+        Result.Name         = "birthday spacings";
+        Result.Statistic    = static_cast<double>(Total.BirthdayDuplicates);
+        Result.PValue       = TwoSidedNormal((Result.Statistic - Mean) / ::sqrt(Mean));
+        Results.push_back(Result);
+    }
+
+    // Serial correlation: each value should say nothing about the next...
+    if(Total.Pairs)
+    {
+        const double Samples    = static_cast<double>(Total.Samples);
+        const double Pairs      = static_cast<double>(Total.Pairs);
+        const double Mean       = Total.Sum / Samples;
+        const double Variance   = Total.SumSquares / Samples - Mean * Mean;
+        const double Covariance = Total.SumProducts / Pairs - Mean * Mean;
+        Result.Name             = "serial correlation";
+        Result.Statistic        = Covariance / Variance;
+        Result.PValue           = TwoSidedNormal(Result.Statistic * ::sqrt(Pairs));
+        Results.push_back(Result);
+    }
+}
+
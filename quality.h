@@ -0,0 +1,54 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Multiple include protection...
+#ifndef _QUALITY_H_
+#define _QUALITY_H_
+
+// Includes...
+
+    // Our headers...
+    #include "random.h"
+
+    // Standard C++...
+    #include <string>
+    #include <vector>
+
+// Which of the generator's outputs a battery is run against...
+typedef enum
+{
+    QualityRaw = 0, /* Raw 64-bit words from a given source. */
+    QualityRange,   /* Bulk range reduction into a non power of two range. */
+    QualityRangeSingle, /* The same range, one value per call. */
+    QualityFloat    /* Bulk conversion to doubles in [0, 1). */
+
+}QualityMode;
+
+// Result of one statistical test...
+struct QualityResult
+{
+    // Name of the test...
+    std::string Name;
+
+    // Test statistic, and the probability of a statistic at least that
+    //  extreme from an ideal generator...
+    double      Statistic;
+    double      PValue;
+};
+
+// Stream the given number of bytes of the generator's output through a
+//  battery of statistical tests, split across the given number of threads.
+//  Raw mode draws from the given source; the others from whichever source is
+//  selected. Results are appended to the given list...
+void RunQualityBattery(
+    RandomNumberGenerator              &Generator,
+    const QualityMode                   Mode,
+    const RandomNumberGenerator::SourceType Source,
+    const uint64_t                      Bytes,
+    const unsigned                      Threads,
+    std::vector<QualityResult>         &Results);
+
+#endif
+
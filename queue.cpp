@@ -0,0 +1,220 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Includes...
+
+    // Ours...
+    #include "queue.h"
+
+// Using the standard namespace...
+using namespace std;
+
+// Constructor...
+RequestQueue::RequestQueue(
+    uv_loop_t                  *Loop,
+    RandomNumberGenerator      &Generator,
+    const DispatchFunction      Dispatch,
+    const DiscardFunction       Discard,
+    void                       *Data)
+    : m_Generator(Generator),
+      m_Dispatch(Dispatch),
+      m_Discard(Discard),
+      m_DispatchData(Data),
+      m_Outstanding(0),
+      m_Stopping(false),
+      m_Notify(new uv_async_t)
+{
+    // Allocate synchronization...
+  ::uv_mutex_init(&m_Mutex);
+  ::uv_cond_init(&m_Wake);
+
+    // Completion notification, which shouldn't keep the loop alive while we
+    //  are idle...
+  ::uv_async_init(Loop, m_Notify, OnCompleted);
+    m_Notify->data = this;
+  ::uv_unref(reinterpret_cast<uv_handle_t *>(m_Notify));
+
+    // Start the worker...
+  ::uv_thread_create(&m_Worker, WorkerThread, this);
+}
+
+// Queue a draw...
+void RequestQueue::Push(const Request &Queued)
+{
+    // Keep the loop alive until this is dispatched...
+    if(m_Outstanding++ == 0)
+      ::uv_ref(reinterpret_cast<uv_handle_t *>(m_Notify));
+
+    // Hand it to the worker, waking it if this is all there is...
+  ::uv_mutex_lock(&m_Mutex);
+    m_Pending.push_back(Queued);
+    if(m_Pending.size() == 1)
+      ::uv_cond_signal(&m_Wake);
+  ::uv_mutex_unlock(&m_Mutex);
+}
+
+// Fill a batch of requests using the generator's bulk paths...
+void RequestQueue::Fill(vector<Request> &Batch)
+{
+    // Scratch space for one run of requests at a time...
+    vector<uint32_t> Words(Batch.size());
+
+    // Work through runs of requests for the same kind of draw, which are
+    //  filled in one call...
+    for(size_t Start = 0; Start < Batch.size();)
+    {
+        // Find the end of this run...
+        const Request &First = Batch[Start];
+        size_t End = Start + 1;
+        while(End < Batch.size() &&
+              Batch[End].Ranged == First.Ranged &&
+              (!First.Ranged ||
+               (Batch[End].Lower == First.Lower &&
+                Batch[End].Upper == First.Upper)))
+            ++End;
+
+        // Fill it...
+        bool CorrectionDetected = false;
+        if(First.Ranged)
+            m_Generator.FillRandomRange32(
+                reinterpret_cast<int32_t *>(&Words[0]),
+                End - Start,
+                First.Lower,
+                First.Upper,
+                CorrectionDetected);
+        else
+            m_Generator.FillRandom32(
+                &Words[0], End - Start, CorrectionDetected);
+
+        // Hand the results out. A correction can't be traced to the word it
+        //  affected, so rather than blame every request in the run, draw each
+        //  of them again on its own...
+        for(size_t Index = Start; Index < End; ++Index)
+        {
+            if(CorrectionDetected)
+                FillOne(Batch[Index]);
+            else
+                Batch[Index].Result = Words[Index - Start];
+        }
+
+        // Next run...
+        Start = End;
+    }
+
+    // Don't leave them lying around...
+    if(!Words.empty())
+        SecureWipe(&Words[0], Words.size() * sizeof(uint32_t));
+}
+
+// Fill a single request on its own...
+void RequestQueue::FillOne(Request &Queued)
+{
+    bool CorrectionDetected = false;
+    if(Queued.Ranged)
+        Queued.Result = static_cast<uint32_t>(m_Generator.GetRandomRange32(
+            Queued.Lower, Queued.Upper, CorrectionDetected));
+    else
+        Queued.Result = m_Generator.GetRandom32(CorrectionDetected);
+    Queued.CorrectionDetected = CorrectionDetected;
+}
+
+// Event loop notification that requests have completed...
+void RequestQueue::OnCompleted(uv_async_t *Handle)
+{
+    // Closing, and we have already gone...
+    RequestQueue *Queue = static_cast<RequestQueue *>(Handle->data);
+    if(!Queue)
+        return;
+
+    // Take everything completed so far. Several notifications may have been
+    //  coalesced into this one...
+    vector<Request> Completed;
+  ::uv_mutex_lock(&Queue->m_Mutex);
+    Completed.swap(Queue->m_Completed);
+  ::uv_mutex_unlock(&Queue->m_Mutex);
+
+    // Nothing new...
+    if(Completed.empty())
+        return;
+
+    // Let the loop exit once nothing is outstanding...
+    Queue->m_Outstanding -= Completed.size();
+    if(Queue->m_Outstanding == 0)
+      ::uv_unref(reinterpret_cast<uv_handle_t *>(Queue->m_Notify));
+
+    // Dispatch the whole batch...
+    Queue->m_Dispatch(Completed, Queue->m_DispatchData);
+}
+
+// Worker thread draining the queue...
+void RequestQueue::WorkerThread(void *Argument)
+{
+    // Our queue...
+    RequestQueue *Queue = static_cast<RequestQueue *>(Argument);
+
+    // Keep draining until asked to stop...
+    vector<Request> Batch;
+    for(;;)
+    {
+        // Wait for something to do...
+      ::uv_mutex_lock(&Queue->m_Mutex);
+        while(Queue->m_Pending.empty() && !Queue->m_Stopping)
+          ::uv_cond_wait(&Queue->m_Wake, &Queue->m_Mutex);
+
+        // Asked to stop...
+        if(Queue->m_Stopping)
+        {
+          ::uv_mutex_unlock(&Queue->m_Mutex);
+            return;
+        }
+
+        // Take everything queued so far, leaving an empty list with the
+        //  capacity we used last time in its place...
+        Batch.swap(Queue->m_Pending);
+      ::uv_mutex_unlock(&Queue->m_Mutex);
+
+        // Fill it all at once...
+        Queue->Fill(Batch);
+
+        // Pass it back to the event loop...
+      ::uv_mutex_lock(&Queue->m_Mutex);
+        Queue->m_Completed.insert(
+            Queue->m_Completed.end(), Batch.begin(), Batch.end());
+      ::uv_mutex_unlock(&Queue->m_Mutex);
+      ::uv_async_send(Queue->m_Notify);
+        Batch.clear();
+    }
+}
+
+// Stop the worker...
+RequestQueue::~RequestQueue()
+{
+    // Wake the worker and wait for it to exit...
+  ::uv_mutex_lock(&m_Mutex);
+    m_Stopping = true;
+  ::uv_cond_signal(&m_Wake);
+  ::uv_mutex_unlock(&m_Mutex);
+  ::uv_thread_join(&m_Worker);
+
+    // Nothing will dispatch whatever is left, so let its owner release it...
+    for(size_t Index = 0; Index < m_Completed.size(); ++Index)
+        m_Discard(m_Completed[Index], m_DispatchData);
+    for(size_t Index = 0; Index < m_Pending.size(); ++Index)
+        m_Discard(m_Pending[Index], m_DispatchData);
+    m_Completed.clear();
+    m_Pending.clear();
+
+    // Detach the notification from us and let libuv free it once closed...
+    m_Notify->data = nullptr;
+  ::uv_close(reinterpret_cast<uv_handle_t *>(m_Notify), [](uv_handle_t *Handle)
+    {
+        delete reinterpret_cast<uv_async_t *>(Handle);
+    });
+
+    // Cleanup synchronization...
+  ::uv_cond_destroy(&m_Wake);
+  ::uv_mutex_destroy(&m_Mutex);
+}
+
@@ -0,0 +1,150 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Multiple include protection...
+#ifndef _REQUEST_QUEUE_H_
+#define _REQUEST_QUEUE_H_
+
+// Includes...
+
+    // Our headers...
+    #include "random.h"
+
+    // Libuv...
+    #include <uv.h>
+
+    // Standard C++...
+#ifdef __APPLE__
+    #include <tr1/cstdint>
+#else
+    #include <cstdint>
+#endif
+    #include <vector>
+
+// Serves many small asynchronous draws from one dedicated worker thread
+//  instead of one threadpool work item each. Requests queued on the event
+//  loop's thread are drained by the worker in batches and filled with the
+//  generator's bulk paths, then every completed request in a batch is handed
+//  back to the event loop with a single notification. The notification handle
+//  only keeps the loop alive while requests are outstanding...
+class RequestQueue
+{
+    // Public attributes...
+    public:
+
+        // One queued draw...
+        struct Request
+        {
+            Request()
+                : Ranged(false),
+                  Lower(0),
+                  Upper(0),
+                  Result(0),
+                  CorrectionDetected(false),
+                  Context(nullptr) {}
+
+            // Whether to draw from [Lower, Upper] rather than all 32 bits...
+            bool        Ranged;
+            int32_t     Lower;
+            int32_t     Upper;
+
+            // Result, to be reinterpreted as signed for ranged draws...
+            uint32_t    Result;
+            bool        CorrectionDetected;
+
+            // Caller's own data, such as the callback to dispatch to...
+            void       *Context;
+        };
+
+        // Called on the event loop's thread with each batch of completed
+        //  requests, in the order they were queued...
+        typedef void (*DispatchFunction)(
+            std::vector<Request> &Completed, void *Data);
+
+        // Called on the event loop's thread with each request that will never
+        //  be dispatched because the queue is being destroyed, so its context
+        //  can be released...
+        typedef void (*DiscardFunction)(Request &Dropped, void *Data);
+
+    // Public methods...
+    public:
+
+        // Constructor. Must be called on the given loop's thread. Both
+        //  functions are passed the given data...
+        RequestQueue(
+            uv_loop_t                  *Loop,
+            RandomNumberGenerator      &Generator,
+            const DispatchFunction      Dispatch,
+            const DiscardFunction       Discard,
+            void                       *Data);
+
+        // Queue a draw. Must be called on the event loop's thread...
+        void Push(const Request &Queued);
+
+        // Stop the worker. Requests not yet dispatched are handed to the
+        //  discard function instead. Must be called on the event loop's
+        //  thread...
+       ~RequestQueue();
+
+    // Protected methods...
+    protected:
+
+        // Fill a batch of requests using the generator's bulk paths...
+        void Fill(std::vector<Request> &Batch);
+
+        // Fill a single request on its own...
+        void FillOne(Request &Queued);
+
+        // Event loop notification that requests have completed...
+        static void OnCompleted(uv_async_t *Handle);
+
+        // Worker thread draining the queue...
+        static void WorkerThread(void *Argument);
+
+    // Private methods...
+    private:
+
+        // Forbid copy constructor and assignment...
+        RequestQueue(const RequestQueue &);
+        RequestQueue &operator=(const RequestQueue &);
+
+    // Protected attributes...
+    protected:
+
+        // Generator to draw from...
+        RandomNumberGenerator  &m_Generator;
+
+        // Where completed batches are sent, and undispatched requests when
+        //  we are destroyed...
+        const DispatchFunction  m_Dispatch;
+        const DiscardFunction   m_Discard;
+        void                   *m_DispatchData;
+
+        // Requests waiting for the worker, and completed ones waiting for the
+        //  event loop...
+        std::vector<Request>    m_Pending;
+        std::vector<Request>    m_Completed;
+
+        // Requests queued but not yet dispatched, only touched on the event
+        //  loop's thread...
+        size_t                  m_Outstanding;
+
+        // Set when the worker should exit...
+        bool                    m_Stopping;
+
+        // Guards the two lists and the flag above, and wakes the worker...
+        uv_mutex_t              m_Mutex;
+        uv_cond_t               m_Wake;
+
+        // Notifies the event loop of completed requests. Lives on the heap so
+        //  it can outlive us until libuv has finished closing it...
+        uv_async_t             *m_Notify;
+
+        // Worker...
+        uv_thread_t             m_Worker;
+};
+
+#endif
+
@@ -6,73 +6,112 @@
 // Includes...
 
     // Ours...
+    #include "bits.h"
     #include "random.h"
 
+    // POSIX...
+    #include <pthread.h>
+
     // Standard C++
 #ifdef __APPLE__
     #include <tr1/cstdint>
 #else
     #include <cstdint>
 #endif
+    #include <algorithm>
+    #include <cmath>
     #include <cstdlib>
+    #include <cstring>
 
 // Using the standard namespace...
 using namespace std;
 
+// Storage for constants passed by reference, such as to std::min()...
+const size_t RandomNumberGenerator::ChunkWords;
+const size_t RandomNumberGenerator::MaximumSlots;
+
 // Default constructor...
 RandomNumberGenerator::RandomNumberGenerator()
-    : m_Corrections(0),
-      m_SourceType(None)
-{
-    // Allocate mutex...
-  ::uv_mutex_init(&m_Mutex);
-
-    // Verify CPU supports CPUID instruction...
-
-        // Storage for EFLAGS register...
-        uint64_t    EFlagsBefore    = 0;
-        uint64_t    EFlagsAfter     = 0;
-
-        // Get EFLAGS register...
-        asm volatile(
-            "pushfq\n"
-            "pop %0\n"
-            : "=r"(EFlagsBefore));
-
-        // Set EFLAGS' ID bit. This bit is modifiable only when the CPUID
-        //  instruction is supported...
-        asm volatile(
-            "push %0\n"
-            "popfq\n"
-            :: "r"(EFlagsBefore ^ 0x200000)); /* Input operands */
-
-        // Get the EFLAGS register again...
-        asm volatile(
-            "pushfq\n"
-            "pop %0\n"
-            : "=r"(EFlagsAfter));   /* Output operands */
-
-        // Not supported if the bit isn't still set...
-        if(!(EFlagsAfter & 0x200000))
-            return;
+    : m_SourceType(IntelSecureKey),
+      m_Arena(nullptr),
+      m_Slots(nullptr),
+      m_Generation(0),
+      m_Journal(nullptr),
+      m_JournalActive(false),
+      m_JournalReplaying(false),
+      m_JournalExhausted(false)
+{
+    // Allocate journal and slot registry locks...
+  ::uv_rwlock_init(&m_JournalLock);
+  ::uv_mutex_init(&m_SlotsMutex);
 
-    // Query CPU for capabilities...
+    // Make sure no child process ever serves state it inherited from us...
+    RegisterForkHandlers();
 
-        // Output registers...
-        uint32_t EAX = 0;
-        uint32_t EBX = 0;
-        uint32_t ECX = 0;
-        uint32_t EDX = 0;
+    // Probing the host and allocating per thread state are both left until
+    //  first needed, so loading the module costs as little as possible...
+}
 
-        // Query...
-        asm volatile(
-            "cpuid"
-            : "=a" (EAX), "=b" (EBX), "=c" (ECX), "=d" (EDX) /* Output operands */
-            : "a" (1)); /* Input operands */
+// State private to one thread using the generator...
+GeneratorSlot::GeneratorSlot(RandomNumberGenerator &Generator)
+    : Corrections(0),
+      Generation(Generator.m_Generation.load(memory_order_relaxed)),
+      Extractor(GetHostCapabilities().RdSeed, Generator.GetKernels())
+{
+}
 
-        // Check for RdRand instruction...
-        if(ECX & (1 << 30))
-            m_SourceType = IntelSecureKey;
+// Add to the number of corrections detected by the owning thread...
+void GeneratorSlot::AddCorrections(const uint32_t Count)
+{
+    Corrections.store(
+        Corrections.load(memory_order_relaxed) + Count,
+        memory_order_relaxed);
+}
+
+// Get every thread's state, allocating it the first time...
+RandomNumberGenerator::SlotRegistry &RandomNumberGenerator::GetSlots()
+{
+    // Already allocated...
+    SlotRegistry *Slots = m_Slots.load(memory_order_acquire);
+    if(Slots)
+        return *Slots;
+
+    // Allocate, unless another thread beat us to it...
+  ::uv_mutex_lock(&m_SlotsMutex);
+    Slots = m_Slots.load(memory_order_relaxed);
+    if(!Slots)
+    {
+        // Each thread keeps its own state in memory that is never swapped or
+        //  dumped...
+        m_Arena = new SecureArena(SlotRegistry::GetStorageBytes(MaximumSlots));
+        Slots   = new SlotRegistry(*this, MaximumSlots, *m_Arena);
+        m_Slots.store(Slots, memory_order_release);
+    }
+  ::uv_mutex_unlock(&m_SlotsMutex);
+
+    // Done...
+    return *Slots;
+}
+
+// Get the calling thread's slot, discarding any state inherited from a
+//  parent process...
+GeneratorSlot &RandomNumberGenerator::AcquireSlot()
+{
+    // Look up the slot...
+    GeneratorSlot &Slot = GetSlots().Acquire();
+
+    // We have forked since this slot last drew, so its buffered output and key
+    //  are shared with our parent and any siblings. Throw them away and rekey
+    //  from fresh entropy before serving anything...
+    const uint32_t Generation = m_Generation.load(memory_order_relaxed);
+    if(Slot.Generation != Generation)
+    {
+        Slot.Extractor.Discard();
+        Slot.Generation = Generation;
+    }
+
+    // Done...
+    return Slot;
 }
 
 // Retrieve a 32-bit unsigned random number...
@@ -99,41 +138,393 @@ uint32_t RandomNumberGenerator::GetRandom32(bool &CorrectionDetected)
 // Retrieve a 64-bit unsigned random number...
 uint64_t RandomNumberGenerator::GetRandom64(bool &CorrectionDetected)
 {
-    // Location for result and carry flag...
-    uint64_t    Result  = 0;
-    uint8_t     Valid   = false;
+    // Storage for the word...
+    uint64_t Result = 0;
+
+    // Fill it...
+    FillRandom64(&Result, 1, CorrectionDetected);
+
+    // Return the new random number to caller...
+    return Result;
+}
 
+// Fill the given buffer with 64-bit unsigned random numbers...
+void RandomNumberGenerator::FillRandom64(
+    uint64_t *Words, const size_t Count, bool &CorrectionDetected)
+{
     // Reset correction flag...
     CorrectionDetected = false;
 
-    // Not supported...
-    if(!IsAvailable())
-        return 0;
+    // Recording or replaying, so take the slow path...
+    if(m_JournalActive.load(memory_order_acquire))
+    {
+        FillJournalled64(Words, Count, CorrectionDetected);
+        return;
+    }
 
-    // Keep trying as long as the carry flag indicates a bad result...
-    do
+    // Go straight to the hardware...
+    FillFromSource64(
+        m_SourceType.load(memory_order_acquire),
+        Words,
+        Count,
+        CorrectionDetected);
+}
+
+// Fill the given buffer with 32-bit unsigned random numbers...
+void RandomNumberGenerator::FillRandom32(
+    uint32_t *Words, const size_t Count, bool &CorrectionDetected)
+{
+    // Reset correction flag...
+    CorrectionDetected = false;
+
+    // Work through the caller's buffer a chunk at a time, using both halves
+    //  of every 64-bit word...
+    uint64_t Chunk[ChunkWords];
+    for(size_t Filled = 0; Filled < Count;)
     {
-        // Perform query and retrieve carry flag...
-        asm volatile(
-            "rdrand %0\n"
-            "setc %1"
-            : "=r" (Result), "=qm"(Valid)
-            :
-            : "rdx");
+        // Draw enough 64-bit words for this chunk...
+        const size_t Take = min(Count - Filled, ChunkWords * 2);
+        bool ChunkCorrected = false;
+        FillRandom64(Chunk, (Take + 1) / 2, ChunkCorrected);
+        CorrectionDetected |= ChunkCorrected;
+
+        // Split them...
+      ::memcpy(&Words[Filled], Chunk, Take * sizeof(uint32_t));
+        Filled += Take;
+    }
 
-        // Remember failed attempts...
-        if(!Valid)
+    // Don't leave them lying around on the stack...
+    SecureWipe(Chunk, sizeof(Chunk));
+}
+
+// Fill the given buffer with 32-bit random numbers within the given
+//  inclusive range...
+void RandomNumberGenerator::FillRandomRange32(
+    int32_t        *Output,
+    const size_t    Count,
+    const int32_t   Lower,
+    const int32_t   Upper,
+    bool           &CorrectionDetected)
+{
+    // Reset correction flag...
+    CorrectionDetected = false;
+
+    // Calculate the range. Zero means the whole 32-bit space...
+    const uint32_t Range =
+        static_cast<uint32_t>(Upper) - static_cast<uint32_t>(Lower) + 1;
+
+    // Products whose low half falls below this would bias the result...
+    const uint32_t Threshold = Range ? (0U - Range) % Range : 0;
+
+    // Work through the caller's buffer a chunk at a time...
+    uint32_t Chunk[ChunkWords * 2];
+    for(size_t Filled = 0; Filled < Count;)
+    {
+        // Draw raw words...
+        const size_t Take = min(Count - Filled, ChunkWords * 2);
+        bool ChunkCorrected = false;
+        FillRandom32(Chunk, Take, ChunkCorrected);
+        CorrectionDetected |= ChunkCorrected;
+
+        // Whole 32-bit space needs no reduction...
+        if(!Range)
         {
-            CorrectionDetected = true;
-          ::uv_mutex_lock(&m_Mutex);
-          ++m_Corrections;
-          ::uv_mutex_unlock(&m_Mutex);
+            for(size_t Index = 0; Index < Take; ++Index)
+                Output[Filled + Index] = static_cast<int32_t>(
+                    Chunk[Index] + static_cast<uint32_t>(Lower));
         }
+
+        // Reduce them all at once. Rarely, some need redrawing...
+        else if(GetKernels().ReduceRange(
+            Chunk, &Output[Filled], Take, Range, Threshold, Lower))
+        {
+            for(size_t Index = 0; Index < Take; ++Index)
+            {
+                // Redraw until this one is unbiased...
+                uint64_t Product = static_cast<uint64_t>(Chunk[Index]) * Range;
+                while(static_cast<uint32_t>(Product) < Threshold)
+                {
+                    bool Corrected = false;
+                    Product = static_cast<uint64_t>(GetRandom32(Corrected)) * Range;
+                    CorrectionDetected |= Corrected;
+                }
+
+                // Store...
+                Output[Filled + Index] = static_cast<int32_t>(
+                    static_cast<uint32_t>(Product >> 32) +
+                    static_cast<uint32_t>(Lower));
+            }
+        }
+
+        // Advance...
+        Filled += Take;
     }
-    while(!Valid);
 
-    // Return the new random number to caller...
-    return Result;
+    // Don't leave them lying around on the stack...
+    SecureWipe(Chunk, sizeof(Chunk));
+}
+
+// Fill the given buffer with independent decisions, each true with exactly
+//  the given probability...
+void RandomNumberGenerator::FillBernoulli(
+    uint8_t        *Output,
+    const size_t    Count,
+    const double    Probability,
+    bool           &CorrectionDetected)
+{
+    // Reset correction flag...
+    CorrectionDetected = false;
+
+    // Certain outcomes need no randomness at all...
+    if(!(Probability > 0.0) || !(Probability < 1.0))
+    {
+      ::memset(Output, (Probability >= 1.0) ? 1 : 0, Count);
+        return;
+    }
+
+    // Split the probability into a 53-bit mantissa, left aligned in a word,
+    //  preceded by a run of zero bits in its binary expansion...
+    int Exponent = 0;
+    const double Fraction = ::frexp(Probability, &Exponent);
+    const uint64_t Mantissa =
+        static_cast<uint64_t>(::ldexp(Fraction, 53)) << 11;
+    const unsigned LeadingZeros = static_cast<unsigned>(-Exponent);
+
+    // Only the mantissa up to its last one bit matters. Once tied that far the
+    //  stream can only be at or above the probability...
+    const unsigned Significant  = 64 - __builtin_ctzll(Mantissa);
+    const uint64_t Mask         = ~((Mantissa & (0 - Mantissa)) - 1);
+
+    // Each decision compares a uniform number in [0, 1) against the
+    //  probability one bit at a time, most significant first, stopping at the
+    //  first bit that settles it. That takes under two bits on average, and
+    //  exactly one when the probability is one half...
+    BitReservoir<RandomNumberGenerator> Reservoir(*this, Count * 2);
+    for(size_t Index = 0; Index < Count; ++Index)
+    {
+        // Result of this decision...
+        uint8_t Decision = 0;
+
+        // Any one bit where the probability has a leading zero means we
+        //  are above it...
+        unsigned Zeros = LeadingZeros;
+        while(Zeros)
+        {
+            // Look at the next run of them...
+            const unsigned Run      = std::min(Zeros, 64U);
+            const uint64_t Window   = Reservoir.Peek();
+            const uint64_t Ones     = (Run < 64)
+                ? (Window >> (64 - Run)) : Window;
+
+            // Found one, consuming only up to it...
+            if(Ones)
+            {
+                Reservoir.Consume(__builtin_clzll(Ones) - (64 - Run) + 1);
+                break;
+            }
+
+            // All zero, so keep going...
+            Reservoir.Consume(Run);
+            Zeros -= Run;
+        }
+
+        // Still tied, so compare against the mantissa...
+        if(!Zeros)
+        {
+            // Bits that differ between the stream and the mantissa...
+            const uint64_t Window       = Reservoir.Peek();
+            const uint64_t Difference   = (Window ^ Mantissa) & Mask;
+
+            // Tied through every significant bit of the mantissa, so the
+            //  stream can only be at or above the probability...
+            if(!Difference)
+                Reservoir.Consume(Significant);
+
+            // The first difference decides. Below the probability if the
+            //  stream has the zero there...
+            else
+            {
+                const unsigned Position = __builtin_clzll(Difference);
+                Decision = (Mantissa >> (63 - Position)) & 1;
+                Reservoir.Consume(Position + 1);
+            }
+        }
+
+        // Store...
+        Output[Index] = Decision;
+    }
+
+    // Remember if any bits needed a correction...
+    CorrectionDetected = Reservoir.GetCorrectionDetected();
+}
+
+// Fill the given buffer with the given number of random bits...
+void RandomNumberGenerator::FillRandomBits(
+    uint8_t *Output, const size_t Bits, bool &CorrectionDetected)
+{
+    // Reset correction flag...
+    CorrectionDetected = false;
+
+    // Work through the caller's buffer a chunk at a time...
+    const size_t Bytes = (Bits + 7) / 8;
+    uint64_t Chunk[ChunkWords];
+    for(size_t Filled = 0; Filled < Bytes;)
+    {
+        // Draw enough words for this chunk...
+        const size_t Take = std::min(Bytes - Filled, sizeof(Chunk));
+        bool ChunkCorrected = false;
+        FillRandom64(Chunk, (Take + 7) / 8, ChunkCorrected);
+        CorrectionDetected |= ChunkCorrected;
+
+        // Copy...
+      ::memcpy(&Output[Filled], Chunk, Take);
+        Filled += Take;
+    }
+
+    // Clear the unused high bits of the last byte...
+    if(Bits % 8)
+        Output[Bytes - 1] &= static_cast<uint8_t>((1U << (Bits % 8)) - 1);
+
+    // Don't leave them lying around on the stack...
+    SecureWipe(Chunk, sizeof(Chunk));
+}
+
+// Fill the given buffer with doubles uniformly distributed in [0, 1)...
+void RandomNumberGenerator::FillRandomDouble(
+    double *Output, const size_t Count, bool &CorrectionDetected)
+{
+    // Reset correction flag...
+    CorrectionDetected = false;
+
+    // Work through the caller's buffer a chunk at a time...
+    uint64_t Chunk[ChunkWords];
+    for(size_t Filled = 0; Filled < Count;)
+    {
+        // Draw raw words...
+        const size_t Take = min(Count - Filled, ChunkWords);
+        bool ChunkCorrected = false;
+        FillRandom64(Chunk, Take, ChunkCorrected);
+        CorrectionDetected |= ChunkCorrected;
+
+        // Convert them all at once...
+        GetKernels().ToDouble(Chunk, &Output[Filled], Take);
+        Filled += Take;
+    }
+
+    // Don't leave them lying around on the stack...
+    SecureWipe(Chunk, sizeof(Chunk));
+}
+
+// Fill the given buffer directly from the given type of random number
+//  generator, bypassing any journal...
+void RandomNumberGenerator::FillFromSource64(
+    const SourceType    Source,
+    uint64_t           *Words,
+    const size_t        Count,
+    bool               &CorrectionDetected)
+{
+    // Number of failed attempts...
+    uint32_t Corrections = 0;
+
+    // Executing an unsupported instruction would fault...
+    if(!IsSourceSupported(Source))
+    {
+      ::memset(Words, 0, Count * sizeof(uint64_t));
+        return;
+    }
+
+    // Draw from the requested source...
+    switch(Source)
+    {
+        // Not supported...
+        case None:
+          ::memset(Words, 0, Count * sizeof(uint64_t));
+            return;
+
+        // RdRand. Keep trying as long as the carry flag indicates a bad
+        //  result...
+        case IntelSecureKey:
+            for(size_t Index = 0; Index < Count; ++Index)
+            {
+                while(!RdRand64Step(Words[Index]))
+                    ++Corrections;
+            }
+            break;
+
+        // RdSeed. Running dry is expected under load and is not a fault, so
+        //  just pause and try again...
+        case IntelSecureKeySeed:
+            for(size_t Index = 0; Index < Count; ++Index)
+            {
+                while(!RdSeed64Step(Words[Index]))
+                    asm volatile("pause");
+            }
+            break;
+
+        // Mixed, using the calling thread's own extractor...
+        case Mixed:
+        {
+            GeneratorSlot &Slot = AcquireSlot();
+            Corrections = Slot.Extractor.Extract(Words, Count);
+            if(Corrections)
+                Slot.AddCorrections(Corrections);
+            GetSlots().Release(Slot);
+            CorrectionDetected = (Corrections != 0);
+            return;
+        }
+    }
+
+    // Remember failed attempts against the calling thread...
+    if(Corrections)
+    {
+        CorrectionDetected = true;
+        SlotRegistry &Slots = GetSlots();
+        GeneratorSlot &Slot = Slots.Acquire();
+        Slot.AddCorrections(Corrections);
+        Slots.Release(Slot);
+    }
+}
+
+// Fill the given buffer while a journal is active...
+void RandomNumberGenerator::FillJournalled64(
+    uint64_t *Words, const size_t Count, bool &CorrectionDetected)
+{
+    // Keep the journal from being closed underneath us...
+  ::uv_rwlock_rdlock(&m_JournalLock);
+
+    // Replaying, so serve recorded words...
+    size_t Replayed = 0;
+    const bool Replaying =
+        m_Journal && m_Journal->GetMode() == RandomJournal::Replaying;
+    if(Replaying)
+    {
+        Replayed = m_Journal->Replay(Words, Count);
+        if(m_Journal->IsExhausted())
+            m_JournalExhausted.store(true, memory_order_release);
+    }
+
+    // Draw whatever is left from the hardware, so the caller isn't handed
+    //  stale words. A replay that ran out can no longer reproduce the run it
+    //  recorded, and hardware output would only make it look as though it
+    //  did, so always flag it...
+    if(Replayed < Count)
+    {
+        FillFromSource64(
+            m_SourceType.load(memory_order_acquire),
+            &Words[Replayed],
+            Count - Replayed,
+            CorrectionDetected);
+        if(Replaying)
+            CorrectionDetected = true;
+    }
+
+    // Recording, so append them to the journal...
+    if(m_Journal && m_Journal->GetMode() == RandomJournal::Recording &&
+       IsSourceSupported(m_SourceType.load(memory_order_acquire)))
+        m_Journal->Record(Words, Count);
+
+    // Done...
+  ::uv_rwlock_rdunlock(&m_JournalLock);
 }
 
 // Retrieve a 32-bit random number within the given inclusive range...
@@ -144,27 +535,309 @@ int32_t RandomNumberGenerator::GetRandomRange32(
     if(!IsAvailable())
         return 0;
 
-    // Calculate the range...
-    const uint32_t Range = ::abs(Upper - Lower) + 1;
+    // Calculate the range. Zero means the whole 32-bit space...
+    const uint32_t Range =
+        static_cast<uint32_t>(Upper) - static_cast<uint32_t>(Lower) + 1;
 
     // Get a random number...
     const uint32_t Random = GetRandom32(CorrectionDetected);
 
-    // Scale and return within the inclusive range...
-    return static_cast<int32_t>((Random % Range) + (Lower));
+    // Whole 32-bit space needs no reduction...
+    if(!Range)
+        return static_cast<int32_t>(Random + static_cast<uint32_t>(Lower));
+
+    // Scale by multiply-shift, the same as the bulk kernels, redrawing
+    //  whenever the low half of the product falls in the biased zone...
+    const uint32_t Threshold = (0U - Range) % Range;
+    uint64_t Product = static_cast<uint64_t>(Random) * Range;
+    while(static_cast<uint32_t>(Product) < Threshold)
+    {
+        bool Corrected = false;
+        Product = static_cast<uint64_t>(GetRandom32(Corrected)) * Range;
+        CorrectionDetected |= Corrected;
+    }
+
+    // Return within the inclusive range...
+    return static_cast<int32_t>(
+        static_cast<uint32_t>(Product >> 32) + static_cast<uint32_t>(Lower));
 }
 
 // Check if a random number generator is available...
 bool RandomNumberGenerator::IsAvailable() const
 {
-    return (m_SourceType != None);
+    // Replaying a journal, which may have been recorded on a host with
+    //  hardware we lack, for as long as it has words left. Once it runs out
+    //  nothing can stand in for it until the replay is stopped...
+    if(m_JournalReplaying.load(memory_order_acquire))
+        return !m_JournalExhausted.load(memory_order_acquire);
+
+    // Otherwise the hardware must be present...
+    return IsSourceSupported(m_SourceType.load(memory_order_acquire));
+}
+
+// Get the type of random number generator in use...
+RandomNumberGenerator::SourceType RandomNumberGenerator::GetSource() const
+{
+    // Preferred source, unless this host turns out not to support it...
+    const SourceType Source = m_SourceType.load(memory_order_acquire);
+    return IsSourceSupported(Source) ? Source : None;
+}
+
+// Number of times random number generator detected an internal problem that
+//  it had to correct before re-supplying a random number...
+uint32_t RandomNumberGenerator::GetCorrections() const
+{
+    // Nothing drawn yet...
+    const SlotRegistry *Slots = m_Slots.load(memory_order_acquire);
+    if(!Slots)
+        return 0;
+
+    // Total across every thread...
+    uint64_t Corrections = 0;
+    Slots->ForEach([&Corrections](const GeneratorSlot &Slot)
+    {
+        Corrections += Slot.Corrections.load(memory_order_relaxed);
+    });
+
+    // Done...
+    return static_cast<uint32_t>(Corrections);
+}
+
+// Get how much each source has contributed to the mixed source...
+EntropyExtractor::Statistics RandomNumberGenerator::GetSourceStatistics() const
+{
+    // Nothing drawn yet...
+    EntropyExtractor::Statistics Totals;
+    const SlotRegistry *Slots = m_Slots.load(memory_order_acquire);
+    if(!Slots)
+        return Totals;
+
+    // Total across every thread's extractor...
+    Slots->ForEach([&Totals](const GeneratorSlot &Slot)
+    {
+        Slot.Extractor.GetStatistics(Totals);
+    });
+
+    // Done...
+    return Totals;
+}
+
+// Get the number of live threads that have drawn from us with their own
+//  state...
+size_t RandomNumberGenerator::GetThreads() const
+{
+    const SlotRegistry *Slots = m_Slots.load(memory_order_acquire);
+    return Slots ? Slots->GetClaimed() : 0;
+}
+
+// Check if every thread's state is locked out of swap...
+bool RandomNumberGenerator::IsMemoryLocked() const
+{
+    // Nothing has been drawn, so there is nothing to lock yet...
+    const SlotRegistry *Slots = m_Slots.load(memory_order_acquire);
+    if(!Slots)
+        return true;
+
+    // Ask where it is kept...
+    return Slots->IsLocked();
+}
+
+// Check if the given type of random number generator is supported...
+bool RandomNumberGenerator::IsSourceSupported(const SourceType Source) const
+{
+    // Probe the host, the first time only...
+    const HostCapabilities &Capabilities = GetHostCapabilities();
+
+    switch(Source)
+    {
+        case IntelSecureKey:        return Capabilities.RdRand;
+        case IntelSecureKeySeed:    return Capabilities.RdSeed;
+        case Mixed:                 return Capabilities.RdRand;
+        default:                    return false;
+    }
+}
+
+// Switch to the given type of random number generator...
+bool RandomNumberGenerator::SetSource(const SourceType Source)
+{
+    // Not supported by this host...
+    if(!IsSourceSupported(Source))
+        return false;
+
+    // Switch...
+    m_SourceType.store(Source);
+    return true;
+}
+
+// Start appending every word served to a journal at the given path...
+bool RandomNumberGenerator::StartRecording(const string &Path)
+{
+    // Create the journal...
+    RandomJournal *Journal = new RandomJournal(Path, RandomJournal::Recording);
+
+    // Failed...
+    if(!Journal->IsOpen())
+    {
+        delete Journal;
+        return false;
+    }
+
+    // Make it active, closing any previous one...
+    SwapJournal(Journal);
+    return true;
+}
+
+// Start serving words from a previously recorded journal...
+bool RandomNumberGenerator::StartReplaying(const string &Path)
+{
+    // Open the journal...
+    RandomJournal *Journal = new RandomJournal(Path, RandomJournal::Replaying);
+
+    // Failed...
+    if(!Journal->IsOpen())
+    {
+        delete Journal;
+        return false;
+    }
+
+    // Make it active, closing any previous one...
+    SwapJournal(Journal);
+    return true;
+}
+
+// Stop recording or replaying, returning the number of words journalled...
+uint64_t RandomNumberGenerator::StopJournal()
+{
+    return SwapJournal(nullptr);
+}
+
+// Replace the active journal, if any, with the given one...
+uint64_t RandomNumberGenerator::SwapJournal(RandomJournal *Journal)
+{
+    // Wait for any draws using the current journal to finish...
+  ::uv_rwlock_wrlock(&m_JournalLock);
+
+    // Swap...
+    RandomJournal *Previous = m_Journal;
+    m_Journal = Journal;
+    m_JournalActive.store(Journal != nullptr, memory_order_release);
+    m_JournalReplaying.store(
+        Journal && Journal->GetMode() == RandomJournal::Replaying,
+        memory_order_release);
+    m_JournalExhausted.store(
+        Journal && Journal->GetMode() == RandomJournal::Replaying &&
+        Journal->IsExhausted(),
+        memory_order_release);
+
+  ::uv_rwlock_wrunlock(&m_JournalLock);
+
+    // Close the previous journal, remembering how many words it held...
+    uint64_t Words = 0;
+    if(Previous)
+    {
+        Words = Previous->GetWords();
+        delete Previous;
+    }
+
+    // Done...
+    return Words;
+}
+
+// Register the fork handlers, once per process...
+void RandomNumberGenerator::RegisterForkHandlers()
+{
+    // Handlers can't be unregistered, so they outlive any one instance and
+    //  check for one themselves...
+    static uv_once_t Once = UV_ONCE_INIT;
+  ::uv_once(&Once, []()
+    {
+        if(::pthread_atfork(ForkPrepare, ForkParent, ForkChild) != 0)
+          ::abort();
+    });
+}
+
+// Called in the forking thread just before fork()...
+void RandomNumberGenerator::ForkPrepare()
+{
+    // Nothing to protect...
+    if(!IsInstantiated())
+        return;
+
+    // Wait for any draw using the journal or claiming a slot to finish, so
+    //  the child doesn't inherit a lock held by a thread it won't have...
+    RandomNumberGenerator &Generator = GetInstance();
+  ::uv_rwlock_wrlock(&Generator.m_JournalLock);
+  ::uv_mutex_lock(&Generator.m_SlotsMutex);
+    SlotRegistry *Slots = Generator.m_Slots.load(memory_order_acquire);
+    if(Slots)
+        Slots->LockAll();
+}
+
+// Called in the parent after fork()...
+void RandomNumberGenerator::ForkParent()
+{
+    // Nothing was locked...
+    if(!IsInstantiated())
+        return;
+
+    // Let draws continue...
+    RandomNumberGenerator &Generator = GetInstance();
+    SlotRegistry *Slots = Generator.m_Slots.load(memory_order_acquire);
+    if(Slots)
+        Slots->UnlockAll();
+  ::uv_mutex_unlock(&Generator.m_SlotsMutex);
+  ::uv_rwlock_wrunlock(&Generator.m_JournalLock);
+}
+
+// Called in the child after fork()...
+void RandomNumberGenerator::ForkChild()
+{
+    // Nothing was locked...
+    if(!IsInstantiated())
+        return;
+
+    // Invalidate every slot's state inherited from our parent. Each slot
+    //  notices and rekeys the next time it is used...
+    RandomNumberGenerator &Generator = GetInstance();
+    Generator.m_Generation.fetch_add(1, memory_order_relaxed);
+
+    // A recording still belongs to our parent, who keeps appending to the
+    //  same file, so let go of it without writing anything. A replay carries
+    //  on deterministically from where the parent was...
+    if(Generator.m_Journal &&
+       Generator.m_Journal->GetMode() == RandomJournal::Recording)
+    {
+        Generator.m_Journal->Abandon();
+        delete Generator.m_Journal;
+        Generator.m_Journal = nullptr;
+        Generator.m_JournalActive.store(false, memory_order_release);
+    }
+
+    // The locks ForkPrepare() took belong to the parent's forking thread.
+    //  Our thread has a different id, so a read-write lock would refuse to
+    //  let us release it. Replace them all with fresh ones instead, and take
+    //  back the slots of threads that didn't come with us...
+    SlotRegistry *Slots = Generator.m_Slots.load(memory_order_acquire);
+    if(Slots)
+        Slots->ResetAfterFork();
+  ::uv_mutex_init(&Generator.m_SlotsMutex);
+  ::uv_rwlock_init(&Generator.m_JournalLock);
 }
 
 // Deconstructor...
 RandomNumberGenerator::~RandomNumberGenerator()
 {
-    // Cleanup mutex...
-  ::uv_mutex_destroy(&m_Mutex);
+    // Close any active journal...
+    SwapJournal(nullptr);
+
+    // Cleanup every thread's state, then wipe and release the memory that
+    //  held it...
+    delete m_Slots.load(memory_order_acquire);
+    delete m_Arena;
+
+    // Cleanup journal and slot registry locks...
+  ::uv_mutex_destroy(&m_SlotsMutex);
+  ::uv_rwlock_destroy(&m_JournalLock);
 }
 
 
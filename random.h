@@ -3,17 +3,53 @@
     Copyright (C) 2016 Cherit.ee Inc
 */
 
+// Multiple include protection...
+#ifndef _RANDOM_NUMBER_GENERATOR_H_
+#define _RANDOM_NUMBER_GENERATOR_H_
+
 // Includes...
 
     // Our headers...
+    #include "arena.h"
+    #include "extractor.h"
+    #include "hardware.h"
+    #include "journal.h"
+    #include "kernels.h"
+    #include "registry.h"
     #include "singleton.h"
 
     // Libuv...
     #include <uv.h>
 
     // Standard C++...
+    #include <atomic>
     #include <string>
 
+// Generator whose state is private to each thread...
+class RandomNumberGenerator;
+
+// State private to one thread using the generator. Aligned to its own cache
+//  lines so that threads never contend for them...
+struct alignas(64) GeneratorSlot
+{
+    // Constructor...
+    explicit GeneratorSlot(RandomNumberGenerator &Generator);
+
+    // Add to the number of corrections detected by the owning thread...
+    void AddCorrections(const uint32_t Count);
+
+    // Number of corrections detected by the owning thread...
+    std::atomic<uint64_t>   Corrections;
+
+    // Process generation the extractor's state belongs to. When it falls
+    //  behind the generator's, we are in a forked child holding a copy of our
+    //  parent's state...
+    uint32_t                Generation;
+
+    // Mixed source key and output block...
+    EntropyExtractor        Extractor;
+};
+
 // Console explicit singleton class...
 class RandomNumberGenerator : public ExplicitSingleton<RandomNumberGenerator>
 {
@@ -21,12 +57,28 @@ class RandomNumberGenerator : public ExplicitSingleton<RandomNumberGenerator>
     //  creation...
     friend class ExplicitSingleton<RandomNumberGenerator>;
 
+    // Per thread state is constructed from what the hardware supports...
+    friend struct GeneratorSlot;
+
+    // Public attributes...
+    public:
+
+        // Type of random number generator to use..
+        typedef enum
+        {
+            None        = 0,
+            IntelSecureKey,     /* Intel hardware random number generator. */
+            IntelSecureKeySeed, /* Intel hardware entropy conditioner. */
+            Mixed               /* RDRAND, RDSEED and kernel, extracted. */
+
+        }SourceType;
+
     // Public methods...
     public:
 
         // Number of times random number generator detected an internal problem
         //  that it had to correct before re-supplying a random number...
-        uint32_t GetCorrections() const { return m_Corrections; }
+        uint32_t GetCorrections() const;
 
         // Retrieve a 32-bit unsigned random number...
         uint32_t GetRandom32(bool &CorrectionDetected);
@@ -38,9 +90,91 @@ class RandomNumberGenerator : public ExplicitSingleton<RandomNumberGenerator>
         int32_t GetRandomRange32(
             const int32_t Lower, const int32_t Upper, bool &CorrectionDetected);
 
+        // Fill the given buffer with independent decisions of one or zero,
+        //  each one with exactly the given probability...
+        void FillBernoulli(
+            uint8_t        *Output,
+            const size_t    Count,
+            const double    Probability,
+            bool           &CorrectionDetected);
+
+        // Fill the given buffer with the given number of random bits, least
+        //  significant first, clearing any unused bits of the last byte...
+        void FillRandomBits(
+            uint8_t *Output, const size_t Bits, bool &CorrectionDetected);
+
+        // Fill the given buffer directly from the given type of random
+        //  number generator, bypassing any journal...
+        void FillFromSource64(
+            const SourceType    Source,
+            uint64_t           *Words,
+            const size_t        Count,
+            bool               &CorrectionDetected);
+
+        // Fill the given buffer with 32-bit unsigned random numbers...
+        void FillRandom32(
+            uint32_t *Words, const size_t Count, bool &CorrectionDetected);
+
+        // Fill the given buffer with 64-bit unsigned random numbers...
+        void FillRandom64(
+            uint64_t *Words, const size_t Count, bool &CorrectionDetected);
+
+        // Fill the given buffer with 32-bit random numbers within the given
+        //  inclusive range...
+        void FillRandomRange32(
+            int32_t        *Output,
+            const size_t    Count,
+            const int32_t   Lower,
+            const int32_t   Upper,
+            bool           &CorrectionDetected);
+
+        // Fill the given buffer with doubles uniformly distributed in
+        //  [0, 1)...
+        void FillRandomDouble(
+            double *Output, const size_t Count, bool &CorrectionDetected);
+
+        // Get the bulk kernels for the widest instruction set this host
+        //  supports...
+        const KernelTable &GetKernels() const
+            { return GetKernelTable(GetHostCapabilities().Kernels); }
+
+        // Get the type of random number generator in use, or none if this
+        //  host has no hardware random number generator...
+        SourceType GetSource() const;
+
+        // Get how much each source has contributed to the mixed source...
+        EntropyExtractor::Statistics GetSourceStatistics() const;
+
+        // Get the number of live threads that have drawn from us with their
+        //  own state...
+        size_t GetThreads() const;
+
         // Check if a random number generator is available...
         bool IsAvailable() const;
 
+        // Check if every thread's state is locked out of swap. False once
+        //  RLIMIT_MEMLOCK has refused to lock some of it...
+        bool IsMemoryLocked() const;
+
+        // Check if the given type of random number generator is supported by
+        //  this host...
+        bool IsSourceSupported(const SourceType Source) const;
+
+        // Switch to the given type of random number generator, returning false
+        //  if it is not supported by this host...
+        bool SetSource(const SourceType Source);
+
+        // Start appending every word served to a journal at the given path...
+        bool StartRecording(const std::string &Path);
+
+        // Start serving words from a previously recorded journal at the given
+        //  path instead of the hardware...
+        bool StartReplaying(const std::string &Path);
+
+        // Stop recording or replaying, returning the number of words
+        //  journalled...
+        uint64_t StopJournal();
+
     // Private methods...
     private:
 
@@ -50,28 +184,83 @@ class RandomNumberGenerator : public ExplicitSingleton<RandomNumberGenerator>
         // Deconstructor...
        ~RandomNumberGenerator();
 
-    // Protected attributes...
+    // Protected types...
     protected:
 
-        // Type of random number generator to use..
-        typedef enum
-        {
-            None        = 0,
-            IntelSecureKey  /* Intel hardware random number generator. */
-
-        }SourceType;
+        // Every thread's state...
+        typedef ThreadSlotRegistry<GeneratorSlot, RandomNumberGenerator>
+            SlotRegistry;
 
     // Protected methods...
     protected:
 
-        // Number of times random number generator detected an internal problem
-        //  that it had to correct before re-supplying a random number...
-        uint32_t    m_Corrections;
+        // Get the calling thread's slot, discarding any buffered state it
+        //  inherited from a parent process. Must be paired with
+        //  GetSlots().Release()...
+        GeneratorSlot &AcquireSlot();
+
+        // Get every thread's state, allocating it on first use...
+        SlotRegistry &GetSlots();
+
+        // Fill the given buffer while a journal is active...
+        void FillJournalled64(
+            uint64_t *Words, const size_t Count, bool &CorrectionDetected);
+
+        // Replace the active journal, if any, with the given one...
+        uint64_t SwapJournal(RandomJournal *Journal);
+
+    // Protected static methods...
+    protected:
 
-        // For thread safety...
-        uv_mutex_t  m_Mutex;
+        // Register the fork handlers below, once per process...
+        static void RegisterForkHandlers();
+
+        // Called in the forking thread just before fork(), and afterwards in
+        //  the parent and the child respectively...
+        static void ForkPrepare();
+        static void ForkParent();
+        static void ForkChild();
+
+    // Protected attributes...
+    protected:
+
+        // Words drawn at a time when filling buffers in bulk...
+        static const size_t ChunkWords = 256;
+
+        // Threads that can have state of their own before the rest share...
+        static const size_t MaximumSlots = 256;
 
         // Type of random number generator to use...
-        SourceType  m_SourceType;
+        std::atomic<SourceType> m_SourceType;
+
+        // Memory holding every thread's state, once allocated...
+        SecureArena            *m_Arena;
+
+        // Each thread's own state, null until something is first drawn...
+        std::atomic<SlotRegistry *> m_Slots;
+
+        // Serializes allocating the above...
+        uv_mutex_t              m_SlotsMutex;
+
+        // Incremented in each child after fork(), so slots can cheaply tell
+        //  that their state was inherited rather than generated here...
+        std::atomic<uint32_t>   m_Generation;
+
+        // Journal being recorded or replayed, if any...
+        RandomJournal          *m_Journal;
+
+        // Checked on every draw so the journal costs nothing when unused...
+        std::atomic<bool>       m_JournalActive;
+
+        // Set while replaying so we are available even without hardware...
+        std::atomic<bool>       m_JournalReplaying;
+
+        // Set once the journal being replayed has nothing left to serve...
+        std::atomic<bool>       m_JournalExhausted;
+
+        // Guards the journal against being closed while a draw is using it...
+        uv_rwlock_t             m_JournalLock;
 };
 
+#endif
+
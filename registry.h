@@ -0,0 +1,395 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Multiple include protection...
+#ifndef _THREAD_SLOT_REGISTRY_H_
+#define _THREAD_SLOT_REGISTRY_H_
+
+// Includes...
+
+    // Our headers...
+    #include "arena.h"
+
+    // Libuv...
+    #include <uv.h>
+
+    // POSIX...
+    #include <pthread.h>
+
+    // System headers...
+    #include <atomic>
+    #include <cstdlib>
+    #include <new>
+    #include <vector>
+
+// Hands each thread its own instance of some per-thread state, so threads
+//  never write to memory another thread is also writing to. Instances live in
+//  one contiguous array of slots carved from a secure arena, each aligned to
+//  and padded out to a whole number of cache lines, and are constructed the
+//  first time their thread asks. The whole array is locked into memory up
+//  front, or where RLIMIT_MEMLOCK won't allow that, a batch of slots at a time
+//  as threads claim them, and if the arena can't hold them at all they live
+//  on the heap unlocked instead. A thread's slot goes
+//  back to the registry when it exits, to be handed as is to the next new
+//  thread, so pools that come and go don't use them up. Threads beyond the
+//  registry's capacity at any one time share one extra slot under a lock. The
+//  owner can visit every slot to aggregate their contents...
+template <class SlotType, class OwnerType>
+class ThreadSlotRegistry
+{
+    // Public methods...
+    public:
+
+        // Get the number of arena bytes needed for the given capacity...
+        static size_t GetStorageBytes(const size_t Capacity)
+        {
+            return sizeof(SlotType) * (Capacity + 1);
+        }
+
+        // Constructor. Slots are constructed with a reference to the owner
+        //  and stored in the given arena, which must outlive us...
+        ThreadSlotRegistry(
+            OwnerType &Owner, const size_t Capacity, SecureArena &Arena)
+            : m_Owner(Owner),
+              m_Arena(Arena),
+              m_Capacity(Capacity),
+              m_Claimed(0),
+              m_Held(0),
+              m_Slots(nullptr),
+              m_Overflow(nullptr),
+              m_OnHeap(false),
+              m_LockedSlots(0),
+              m_Tickets(Capacity + 1)
+        {
+            // Slots must not share a cache line with their neighbours...
+            static_assert(alignof(SlotType) >= CacheLineBytes,
+                "slots must be cache line aligned");
+
+            // Reserve storage for every slot, plus the overflow slot at the end,
+            //  without constructing any of them yet. If the arena couldn't be
+            //  mapped, carry on unlocked from the heap rather than take the
+            //  host process down. Node.js modules are built without
+            //  exceptions, so if even that fails there is no way to report it
+            //  other than to give up...
+            void *Storage = Arena.Allocate(
+                GetStorageBytes(Capacity), alignof(SlotType));
+            if(!Storage)
+            {
+                const int Result = ::posix_memalign(
+                    &Storage, alignof(SlotType), GetStorageBytes(Capacity));
+                if(Result != 0)
+                  ::abort();
+                m_OnHeap = true;
+            }
+            m_Slots = static_cast<SlotType *>(Storage);
+
+            // Overflow slot is always present...
+            m_Overflow = new (&m_Slots[Capacity]) SlotType(m_Owner);
+            LockStorage();
+
+            // Each slot's ticket, which is what a thread actually holds so
+            //  that it can find its way back here when the thread exits...
+            for(size_t Index = 0; Index <= Capacity; ++Index)
+            {
+                m_Tickets[Index].Registry   = this;
+                m_Tickets[Index].Slot       = &m_Slots[Index];
+            }
+            m_Free.reserve(Capacity);
+
+            // Allocate synchronization and thread local storage...
+          ::uv_mutex_init(&m_Mutex);
+          ::uv_mutex_init(&m_OverflowMutex);
+            if(::pthread_key_create(&m_Key, OnThreadExit) != 0)
+              ::abort();
+        }
+
+        // Get the calling thread's slot, claiming one the first time. Must be
+        //  paired with Release()...
+        SlotType &Acquire()
+        {
+            // Look up the calling thread's slot, claiming one the first
+            //  time...
+            Ticket *Held = static_cast<Ticket *>(::pthread_getspecific(m_Key));
+            SlotType *Slot = Held ? Held->Slot : Claim();
+
+            // The overflow slot is shared, so serialize access...
+            if(Slot == m_Overflow)
+              ::uv_mutex_lock(&m_OverflowMutex);
+
+            // Done...
+            return *Slot;
+        }
+
+        // Visit every constructed slot, such as to aggregate counters. Slots
+        //  may be in use by their threads concurrently...
+        template <typename Visitor_t>
+        void ForEach(Visitor_t Visitor) const
+        {
+            // Only slots that have finished being constructed...
+            const size_t Claimed = m_Claimed.load(std::memory_order_acquire);
+            for(size_t Index = 0; Index < Claimed; ++Index)
+                Visitor(m_Slots[Index]);
+
+            // And the overflow slot...
+            Visitor(*m_Overflow);
+        }
+
+        // Hold every lock the registry uses, so that fork() can't leave the
+        //  child with one held by a thread it doesn't have. Must be paired
+        //  with UnlockAll() in the parent and ResetAfterFork() in the child...
+        void LockAll()
+        {
+          ::uv_mutex_lock(&m_Mutex);
+          ::uv_mutex_lock(&m_OverflowMutex);
+        }
+
+        // Release the locks taken by LockAll()...
+        void UnlockAll()
+        {
+          ::uv_mutex_unlock(&m_OverflowMutex);
+          ::uv_mutex_unlock(&m_Mutex);
+        }
+
+        // Replace every lock with a fresh one in a child after fork(). The
+        //  ones LockAll() took belong to the forking thread in the parent,
+        //  which the child's thread can't reliably release. The only thread
+        //  the child has is the forking one, so every other slot is returned
+        //  as though its thread had exited. Memory locks aren't inherited
+        //  either, so every slot in use is locked again...
+        void ResetAfterFork()
+        {
+            // Fresh locks...
+          ::uv_mutex_init(&m_Mutex);
+          ::uv_mutex_init(&m_OverflowMutex);
+
+            // Lock the storage back into memory, as much as before...
+            const size_t Constructed =
+                m_Claimed.load(std::memory_order_relaxed);
+            LockStorage();
+            LockThrough(Constructed);
+
+            // Keep only the calling thread's slot, if it has one...
+            const Ticket *Kept =
+                static_cast<Ticket *>(::pthread_getspecific(m_Key));
+            m_Free.clear();
+            for(size_t Index = 0; Index < Constructed; ++Index)
+            {
+                if(&m_Tickets[Index] != Kept)
+                    m_Free.push_back(&m_Tickets[Index]);
+            }
+            m_Held.store(
+                Constructed - m_Free.size(), std::memory_order_relaxed);
+        }
+
+        // Check if every constructed slot is locked into memory...
+        bool IsLocked() const
+        {
+            return !m_OnHeap && m_Arena.IsLocked();
+        }
+
+        // Get the number of live threads holding their own slot...
+        size_t GetClaimed() const
+        {
+            return m_Held.load(std::memory_order_relaxed);
+        }
+
+        // Release the slot returned by Acquire()...
+        void Release(SlotType &Slot)
+        {
+            if(&Slot == m_Overflow)
+              ::uv_mutex_unlock(&m_OverflowMutex);
+        }
+
+        // Deconstructor. No thread may be using a slot...
+       ~ThreadSlotRegistry()
+        {
+            // Destroy every constructed slot...
+            const size_t Claimed = m_Claimed.load(std::memory_order_acquire);
+            for(size_t Index = 0; Index < Claimed; ++Index)
+                m_Slots[Index].~SlotType();
+            m_Overflow->~SlotType();
+
+            // Storage belongs to the arena, but wipe it now rather than
+            //  leaving whatever the slots held until the arena goes...
+            SecureWipe(m_Slots, GetStorageBytes(m_Capacity));
+            if(m_OnHeap)
+              ::free(m_Slots);
+
+            // Cleanup synchronization and thread local storage. Threads that
+            //  exit from here on no longer call back into us...
+          ::pthread_key_delete(m_Key);
+          ::uv_mutex_destroy(&m_OverflowMutex);
+          ::uv_mutex_destroy(&m_Mutex);
+        }
+
+    // Protected attributes...
+    protected:
+
+        // Size of a cache line on every x86-64 we know of...
+        static const size_t CacheLineBytes = 64;
+
+        // Slots locked into memory at a time when they can't all be...
+        static const size_t LockBatchSlots = 8;
+
+    // Protected methods...
+    protected:
+
+        // Claim a slot for the calling thread...
+        SlotType *Claim()
+        {
+            // One thread claims at a time so slots are constructed in order...
+          ::uv_mutex_lock(&m_Mutex);
+
+            // Take back one a thread left behind when it exited, otherwise
+            //  construct the next slot, otherwise share the overflow slot...
+            Ticket *Claimed = &m_Tickets[m_Capacity];
+            const size_t Constructed =
+                m_Claimed.load(std::memory_order_relaxed);
+            if(!m_Free.empty())
+            {
+                Claimed = m_Free.back();
+                m_Free.pop_back();
+            }
+            else if(Constructed < m_Capacity)
+            {
+                new (&m_Slots[Constructed]) SlotType(m_Owner);
+                LockThrough(Constructed + 1);
+                Claimed = &m_Tickets[Constructed];
+                m_Claimed.store(Constructed + 1, std::memory_order_release);
+            }
+
+            // Count it if it is ours alone...
+            if(Claimed->Slot != m_Overflow)
+                m_Held.fetch_add(1, std::memory_order_relaxed);
+
+          ::uv_mutex_unlock(&m_Mutex);
+
+            // Remember it for next time...
+          ::pthread_setspecific(m_Key, Claimed);
+            return Claimed->Slot;
+        }
+
+        // Lock the whole storage into memory with one system call if
+        //  RLIMIT_MEMLOCK allows. Otherwise lock just the overflow slot, and
+        //  leave the rest to LockThrough() as slots are claimed...
+        void LockStorage()
+        {
+            // Nothing to lock...
+            if(m_OnHeap)
+                return;
+
+            // Everything at once...
+            if(m_Arena.TryLock(m_Slots, GetStorageBytes(m_Capacity)))
+            {
+                m_LockedSlots = m_Capacity;
+                return;
+            }
+
+            // Only what is already in use...
+            m_LockedSlots = 0;
+            m_Arena.Lock(m_Overflow, sizeof(SlotType));
+        }
+
+        // Make sure at least the given number of slots from the start are
+        //  locked into memory, locking a whole batch at a time so claiming
+        //  slots doesn't cost a system call each. Must hold m_Mutex...
+        void LockThrough(const size_t Slots)
+        {
+            // Already locked, or nothing to lock...
+            if(m_OnHeap || Slots <= m_LockedSlots)
+                return;
+
+            // Round up to a whole batch, as far as there are slots. Even if
+            //  this fails we move on, since retrying would only fail again...
+            size_t Through = m_LockedSlots + LockBatchSlots;
+            if(Through < Slots)
+                Through = Slots;
+            if(Through > m_Capacity)
+                Through = m_Capacity;
+            m_Arena.Lock(
+                &m_Slots[m_LockedSlots],
+                sizeof(SlotType) * (Through - m_LockedSlots));
+            m_LockedSlots = Through;
+        }
+
+        // Called with the calling thread's ticket as it exits, to return its
+        //  slot to the registry...
+        static void OnThreadExit(void *Value)
+        {
+            // Sharing the overflow slot, which stays where it is...
+            Ticket *Held = static_cast<Ticket *>(Value);
+            ThreadSlotRegistry *Registry = Held->Registry;
+            if(Held->Slot == Registry->m_Overflow)
+                return;
+
+            // Hand it to the next new thread...
+          ::uv_mutex_lock(&Registry->m_Mutex);
+            Registry->m_Free.push_back(Held);
+            Registry->m_Held.fetch_sub(1, std::memory_order_relaxed);
+          ::uv_mutex_unlock(&Registry->m_Mutex);
+        }
+
+    // Protected types...
+    protected:
+
+        // What each thread holding a slot keeps in thread local storage...
+        struct Ticket
+        {
+            ThreadSlotRegistry *Registry;
+            SlotType           *Slot;
+        };
+
+    // Private methods...
+    private:
+
+        // Forbid copy constructor and assignment...
+        ThreadSlotRegistry(const ThreadSlotRegistry &);
+        ThreadSlotRegistry &operator=(const ThreadSlotRegistry &);
+
+    // Protected attributes...
+    protected:
+
+        // Passed to each slot's constructor...
+        OwnerType              &m_Owner;
+
+        // Where the slots live...
+        SecureArena            &m_Arena;
+
+        // Number of slots that can be claimed outright...
+        const size_t            m_Capacity;
+
+        // Number of slots constructed so far...
+        std::atomic<size_t>     m_Claimed;
+
+        // Number of those held by a live thread...
+        std::atomic<size_t>     m_Held;
+
+        // Slot storage, followed by the overflow slot...
+        SlotType               *m_Slots;
+        SlotType               *m_Overflow;
+
+        // Set if the storage came from the heap because the arena had none...
+        bool                    m_OnHeap;
+
+        // Number of slots from the start known to be locked into memory,
+        //  guarded by m_Mutex...
+        size_t                  m_LockedSlots;
+
+        // Ticket for each slot, including the overflow slot, and those of
+        //  slots whose thread has exited...
+        std::vector<Ticket>     m_Tickets;
+        std::vector<Ticket *>   m_Free;
+
+        // Serializes claiming and returning slots, and access to the overflow
+        //  slot...
+        uv_mutex_t              m_Mutex;
+        uv_mutex_t              m_OverflowMutex;
+
+        // Each thread's ticket...
+        pthread_key_t           m_Key;
+};
+
+#endif
+
@@ -0,0 +1,578 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Includes...
+
+    // Ours...
+    #include "selftest.h"
+    #include "bignum.h"
+    #include "hardware.h"
+    #include "kernels.h"
+
+    // POSIX...
+    #include <signal.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+
+    // Standard C++...
+    #include <atomic>
+    #include <cerrno>
+    #include <cmath>
+    #include <cstdio>
+    #include <cstring>
+    #include <vector>
+
+// Using the standard namespace...
+using namespace std;
+
+// Deterministic input for checks that compare outputs, so that a failure can
+//  be reproduced. SplitMix64 is plenty for that...
+static uint64_t NextInput(uint64_t &State)
+{
+    uint64_t Word = (State += 0x9e3779b97f4a7c15ULL);
+    Word = (Word ^ (Word >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    Word = (Word ^ (Word >> 27)) * 0x94d049bb133111ebULL;
+    return Word ^ (Word >> 31);
+}
+
+// Run the kernels of every instruction set level this host supports on the
+//  same input and check that they all agree with the baseline...
+bool CheckKernels(string &Failure)
+{
+    // Lengths covering empty input, every partial group of lanes at every
+    //  level, and several whole ones...
+    static const size_t Lengths[] = { 0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 33, 1000 };
+
+    // Ranges covering one value, a power of two, rejection in most products,
+    //  and nearly the whole 32-bit space...
+    static const uint32_t Ranges[] = { 1, 6, 1000, 65536, 3000000019U, 0xffffffffU };
+
+    // Baseline every other level is compared against...
+    const KernelTable &Baseline = GetKernelTable(KernelBaseline);
+
+    // Input shared by every level, including words at the extremes...
+    uint64_t State = 0x6e6f64652d726e67ULL;
+    vector<uint64_t> Words(1000);
+    for(size_t Index = 0; Index < Words.size(); ++Index)
+        Words[Index] = NextInput(State);
+    Words[0] = 0;
+    Words[1] = ~0ULL;
+    const uint64_t Key[2] = { NextInput(State), NextInput(State) };
+
+    // Storage for each level's output...
+    vector<int32_t>     ExpectedRanged(Words.size() * 2),   Ranged(Words.size() * 2);
+    vector<double>      ExpectedDoubles(Words.size()),      Doubles(Words.size());
+    vector<uint64_t>    ExpectedExtracted(Words.size()),    Extracted(Words.size());
+
+    // Every level above the baseline this host can run...
+    const KernelLevel Highest = GetHostCapabilities().Kernels;
+    for(int Level = KernelAvx2; Level <= Highest; ++Level)
+    {
+        // Kernels under test...
+        const KernelTable &Kernels =
+            GetKernelTable(static_cast<KernelLevel>(Level));
+
+        // Every length...
+        for(size_t Length = 0; Length < sizeof(Lengths) / sizeof(Lengths[0]); ++Length)
+        {
+            // This many words, and twice as many halves for range reduction...
+            const size_t Count = Lengths[Length];
+            const uint32_t *Halves = reinterpret_cast<const uint32_t *>(&Words[0]);
+
+            // Range reduction, at every range, including whether any product
+            //  was flagged for redrawing...
+            for(size_t Range = 0; Range < sizeof(Ranges) / sizeof(Ranges[0]); ++Range)
+            {
+                const uint32_t Threshold = (0U - Ranges[Range]) % Ranges[Range];
+                const bool ExpectedRejected = Baseline.ReduceRange(
+                    Halves, &ExpectedRanged[0], Count * 2, Ranges[Range],
+                    Threshold, -12345);
+                const bool Rejected = Kernels.ReduceRange(
+                    Halves, &Ranged[0], Count * 2, Ranges[Range],
+                    Threshold, -12345);
+                if(Rejected != ExpectedRejected ||
+                   ::memcmp(&Ranged[0], &ExpectedRanged[0], Count * 2 * sizeof(int32_t)) != 0)
+                {
+                    Failure = string(Kernels.Name) + " range reduction differs from baseline";
+                    return false;
+                }
+            }
+
+            // Conversion to doubles...
+            Baseline.ToDouble(&Words[0], &ExpectedDoubles[0], Count);
+            Kernels.ToDouble(&Words[0], &Doubles[0], Count);
+            if(::memcmp(&Doubles[0], &ExpectedDoubles[0], Count * sizeof(double)) != 0)
+            {
+                Failure = string(Kernels.Name) + " double conversion differs from baseline";
+                return false;
+            }
+
+            // Extraction, from a counter that wraps part way through...
+            const uint64_t Counter = ~0ULL - 5;
+            Baseline.Extract(Key, &Words[0], &ExpectedExtracted[0], Count, Counter);
+            Kernels.Extract(Key, &Words[0], &Extracted[0], Count, Counter);
+            if(::memcmp(&Extracted[0], &ExpectedExtracted[0], Count * sizeof(uint64_t)) != 0)
+            {
+                Failure = string(Kernels.Name) + " extraction differs from baseline";
+                return false;
+            }
+        }
+    }
+
+    // Done...
+    return true;
+}
+
+// What a forked child reports back to its parent...
+struct ForkReport
+{
+    // Empty if the child passed...
+    char        Failure[128];
+
+    // First words of the child's mixed output...
+    uint64_t    Mixed[4];
+};
+
+// Body of the child in CheckFork(), filling in the given report...
+static void RunForkChild(
+    RandomNumberGenerator  &Generator,
+    const string           &Directory,
+    const uint64_t         *Expected,
+    ForkReport             &Report)
+{
+    // Keep drawing from the replay our parent was part way through...
+    uint64_t Words[8];
+    bool CorrectionDetected = false;
+    Generator.FillRandom64(Words, 8, CorrectionDetected);
+    if(::memcmp(Words, Expected, sizeof(Words)) != 0)
+    {
+      ::snprintf(Report.Failure, sizeof(Report.Failure),
+            "child did not continue the replay where its parent was");
+        return;
+    }
+
+    // Stop it, then record and stop a journal of our own...
+    Generator.StopJournal();
+    const string Path = Directory + "/rng-selftest-fork-child.journal";
+    if(!Generator.StartRecording(Path))
+    {
+      ::snprintf(Report.Failure, sizeof(Report.Failure),
+            "child could not start recording");
+        return;
+    }
+    Generator.FillRandom64(Words, 8, CorrectionDetected);
+    const uint64_t Recorded = Generator.StopJournal();
+  ::unlink(Path.c_str());
+    if(Recorded != 8)
+    {
+      ::snprintf(Report.Failure, sizeof(Report.Failure),
+            "child recorded %llu words rather than 8",
+            static_cast<unsigned long long>(Recorded));
+        return;
+    }
+
+    // Draw from the mixed source, which our parent had already drawn from...
+    if(Generator.IsSourceSupported(RandomNumberGenerator::Mixed))
+        Generator.FillFromSource64(
+            RandomNumberGenerator::Mixed, Report.Mixed, 4, CorrectionDetected);
+}
+
+// Fork while replaying a journal, then check the child can carry on...
+bool CheckFork(
+    RandomNumberGenerator  &Generator,
+    const string           &Directory,
+    string                 &Failure)
+{
+    // Without hardware there is nothing to record, and nothing else here
+    //  would work either...
+    if(!Generator.IsAvailable())
+        return true;
+
+    // Leave something buffered in the mixed source for the child to inherit...
+    const bool HasMixed =
+        Generator.IsSourceSupported(RandomNumberGenerator::Mixed);
+    uint64_t Mixed[4];
+    bool CorrectionDetected = false;
+    if(HasMixed)
+        Generator.FillFromSource64(
+            RandomNumberGenerator::Mixed, Mixed, 1, CorrectionDetected);
+
+    // Record a journal to replay...
+    const string Path = Directory + "/rng-selftest-fork.journal";
+    uint64_t Recorded[16];
+    if(!Generator.StartRecording(Path))
+    {
+        Failure = "could not record a journal in " + Directory;
+        return false;
+    }
+    Generator.FillRandom64(Recorded, 16, CorrectionDetected);
+    Generator.StopJournal();
+
+    // Start replaying it, and get part way through...
+    uint64_t Words[8];
+    if(!Generator.StartReplaying(Path))
+    {
+      ::unlink(Path.c_str());
+        Failure = "could not replay the journal just recorded";
+        return false;
+    }
+  ::unlink(Path.c_str());
+    Generator.FillRandom64(Words, 8, CorrectionDetected);
+
+    // Channel for the child's report...
+    int Channel[2];
+    if(::pipe(Channel) != 0)
+    {
+        Generator.StopJournal();
+        Failure = "could not create a pipe";
+        return false;
+    }
+
+    // Fork...
+    const pid_t Child = ::fork();
+    if(Child == -1)
+    {
+      ::close(Channel[0]);
+      ::close(Channel[1]);
+        Generator.StopJournal();
+        Failure = "could not fork";
+        return false;
+    }
+
+    // Child. A lock left held across fork() shows up as a hang, so give up
+    //  after a while rather than waiting forever...
+    if(Child == 0)
+    {
+      ::close(Channel[0]);
+      ::alarm(10);
+        ForkReport Report;
+      ::memset(&Report, 0, sizeof(Report));
+        RunForkChild(Generator, Directory, &Recorded[8], Report);
+        const ssize_t Written = ::write(Channel[1], &Report, sizeof(Report));
+      ::_exit(Written == sizeof(Report) ? 0 : 1);
+    }
+
+    // Parent carries on with the replay too, independently of the child...
+  ::close(Channel[1]);
+    Generator.FillRandom64(Words, 8, CorrectionDetected);
+    Generator.StopJournal();
+    const bool ParentContinued =
+        (::memcmp(Words, &Recorded[8], sizeof(Words)) == 0);
+
+    // Draw from the mixed source to compare against the child's...
+    if(HasMixed)
+        Generator.FillFromSource64(
+            RandomNumberGenerator::Mixed, Mixed, 4, CorrectionDetected);
+
+    // Collect the child's report, and the child...
+    ForkReport Report;
+    const ssize_t Read = ::read(Channel[0], &Report, sizeof(Report));
+  ::close(Channel[0]);
+    int Status = 0;
+    while(::waitpid(Child, &Status, 0) == -1 && errno == EINTR)
+        ;
+
+    // Child hung or died...
+    if(Read != sizeof(Report) || !WIFEXITED(Status) || WEXITSTATUS(Status) != 0)
+    {
+        Failure = "child hung or crashed after fork";
+        return false;
+    }
+
+    // Child reported a problem...
+    if(Report.Failure[0])
+    {
+        Failure = Report.Failure;
+        return false;
+    }
+
+    // Our replay should have been unaffected by the child's...
+    if(!ParentContinued)
+    {
+        Failure = "parent did not continue its replay after fork";
+        return false;
+    }
+
+    // Child must not have served the mixed output it inherited from us...
+    if(HasMixed && ::memcmp(Mixed, Report.Mixed, sizeof(Mixed)) == 0)
+    {
+        Failure = "child served the same mixed output as its parent";
+        return false;
+    }
+
+    // Done...
+    return true;
+}
+
+// Record a journal in a child process that is then killed without closing
+//  it, and check that every word it drew replays...
+bool CheckJournalCrash(
+    RandomNumberGenerator  &Generator,
+    const string           &Directory,
+    string                 &Failure)
+{
+    // Without hardware there is nothing to record...
+    if(!Generator.IsAvailable())
+        return true;
+
+    // Channel for the child's words...
+    const string Path = Directory + "/rng-selftest-crash.journal";
+    int Channel[2];
+    if(::pipe(Channel) != 0)
+    {
+        Failure = "could not create a pipe";
+        return false;
+    }
+
+    // Fork...
+    const pid_t Child = ::fork();
+    if(Child == -1)
+    {
+      ::close(Channel[0]);
+      ::close(Channel[1]);
+        Failure = "could not fork";
+        return false;
+    }
+
+    // Child records some words, hands them to its parent, and dies without
+    //  running any destructors...
+    uint64_t Words[64];
+    bool CorrectionDetected = false;
+    if(Child == 0)
+    {
+      ::close(Channel[0]);
+        if(!Generator.StartRecording(Path))
+          ::_exit(1);
+        Generator.FillRandom64(Words, 64, CorrectionDetected);
+        if(::write(Channel[1], Words, sizeof(Words)) != sizeof(Words))
+          ::_exit(1);
+      ::kill(::getpid(), SIGKILL);
+    }
+
+    // Collect the child's words, and the child...
+  ::close(Channel[1]);
+    const ssize_t Read = ::read(Channel[0], Words, sizeof(Words));
+  ::close(Channel[0]);
+    int Status = 0;
+    while(::waitpid(Child, &Status, 0) == -1 && errno == EINTR)
+        ;
+    if(Read != sizeof(Words) || !WIFSIGNALED(Status))
+    {
+      ::unlink(Path.c_str());
+        Failure = "child could not record a journal in " + Directory;
+        return false;
+    }
+
+    // Replay what it left behind...
+    if(!Generator.StartReplaying(Path))
+    {
+      ::unlink(Path.c_str());
+        Failure = "journal left by a killed process could not be replayed";
+        return false;
+    }
+  ::unlink(Path.c_str());
+    uint64_t Replayed[64];
+    Generator.FillRandom64(Replayed, 64, CorrectionDetected);
+    const uint64_t Served = Generator.StopJournal();
+
+    // Every word the child drew should have come back...
+    if(Served != 64 || ::memcmp(Words, Replayed, sizeof(Words)) != 0)
+    {
+        Failure = "journal left by a killed process did not replay every word";
+        return false;
+    }
+
+    // Done...
+    return true;
+}
+
+// Draw a few million decisions at each of several probabilities and check
+//  their means...
+bool CheckBernoulli(RandomNumberGenerator &Generator, string &Failure)
+{
+    // Dyadic probabilities that stop after a bit or two, ones that never
+    //  stop, and ones far out in either tail...
+    static const double Probabilities[] =
+        { 0.5, 0.25, 0.3, 1.0 / 3.0, 0.001, 0.999 };
+
+    // Decisions drawn at each...
+    vector<uint8_t> Decisions(4 * 1024 * 1024);
+    bool CorrectionDetected = false;
+
+    // Certain outcomes...
+    for(int Certain = 0; Certain <= 1; ++Certain)
+    {
+        Generator.FillBernoulli(
+            &Decisions[0], Decisions.size(), Certain, CorrectionDetected);
+        for(size_t Index = 0; Index < Decisions.size(); ++Index)
+        {
+            if(Decisions[Index] != Certain)
+            {
+                Failure = "decision with certain outcome came out otherwise";
+                return false;
+            }
+        }
+    }
+
+    // Each probability...
+    for(size_t Which = 0;
+        Which < sizeof(Probabilities) / sizeof(Probabilities[0]); ++Which)
+    {
+        // Draw...
+        const double Probability = Probabilities[Which];
+        Generator.FillBernoulli(
+            &Decisions[0], Decisions.size(), Probability, CorrectionDetected);
+        if(CorrectionDetected)
+        {
+            Failure = "correction detected while drawing decisions";
+            return false;
+        }
+
+        // Count, making sure each is a one or a zero...
+        size_t Ones = 0;
+        for(size_t Index = 0; Index < Decisions.size(); ++Index)
+        {
+            if(Decisions[Index] > 1)
+            {
+                Failure = "decision was neither one nor zero";
+                return false;
+            }
+            Ones += Decisions[Index];
+        }
+
+        // Mean within six standard deviations...
+        const double Count = static_cast<double>(Decisions.size());
+        const double Deviation =
+            ::sqrt(Probability * (1.0 - Probability) / Count);
+        const double Mean = static_cast<double>(Ones) / Count;
+        if(::fabs(Mean - Probability) > 6.0 * Deviation)
+        {
+            char Description[128];
+          ::snprintf(Description, sizeof(Description),
+                "mean %.6f of decisions with probability %.6f is off",
+                Mean, Probability);
+            Failure = Description;
+            return false;
+        }
+    }
+
+    // Done...
+    return true;
+}
+
+// Get 2^Exponent - 1...
+static BigNumber MersenneNumber(const unsigned Exponent)
+{
+    BigNumber Number((Exponent + 63) / 64, ~0ULL);
+    if(Exponent % 64)
+        Number.back() = (1ULL << (Exponent % 64)) - 1;
+    return Number;
+}
+
+// Check Miller-Rabin against known answers and random primes' sizes...
+bool CheckPrimes(RandomNumberGenerator &Generator, string &Failure)
+{
+    // Numbers that fit in a word, and whether each is prime. Carmichael
+    //  numbers fool Fermat's test to every coprime base, 3215031751 is also a
+    //  strong pseudoprime to bases 2, 3, 5 and 7, and 3825123056546413051 to
+    //  every base up to 23...
+    static const struct
+    {
+        uint64_t    Number;
+        bool        Prime;
+        const char *Name;
+    }
+    Known[] =
+    {
+        { 0,                        false,  "0" },
+        { 1,                        false,  "1" },
+        { 2,                        true,   "2" },
+        { 3,                        true,   "3" },
+        { 4,                        false,  "4" },
+        { 561,                      false,  "Carmichael 561" },
+        { 2047,                     false,  "base 2 pseudoprime 2047" },
+        { 3215031751ULL,            false,  "Carmichael 3215031751" },
+        { 3825123056546413051ULL,   false,  "3825123056546413051" },
+        { 18446744073709551557ULL,  true,   "2^64 - 59" }
+    };
+
+    // Mersenne numbers, and whether each is prime...
+    static const struct
+    {
+        unsigned    Exponent;
+        bool        Prime;
+    }
+    Mersenne[] =
+    {
+        { 61,   true },
+        { 67,   false },
+        { 127,  true },
+        { 521,  true },
+        { 523,  false },
+        { 607,  true }
+    };
+
+    // Sizes of random prime to draw...
+    static const size_t Sizes[] = { 2, 3, 8, 63, 64, 65, 128, 521, 1024 };
+
+    // Each small number...
+    bool CorrectionDetected = false;
+    for(size_t Index = 0; Index < sizeof(Known) / sizeof(Known[0]); ++Index)
+    {
+        const BigNumber Number(1, Known[Index].Number);
+        if(IsProbablePrime(Generator, Number, CorrectionDetected) !=
+           Known[Index].Prime)
+        {
+            Failure = string(Known[Index].Prime ? "prime " : "composite ") +
+                Known[Index].Name + " was misjudged";
+            return false;
+        }
+    }
+
+    // Each Mersenne number...
+    for(size_t Index = 0; Index < sizeof(Mersenne) / sizeof(Mersenne[0]); ++Index)
+    {
+        const BigNumber Number = MersenneNumber(Mersenne[Index].Exponent);
+        if(IsProbablePrime(Generator, Number, CorrectionDetected) !=
+           Mersenne[Index].Prime)
+        {
+            char Description[128];
+          ::snprintf(Description, sizeof(Description),
+                "%s 2^%u - 1 was misjudged",
+                Mersenne[Index].Prime ? "prime" : "composite",
+                Mersenne[Index].Exponent);
+            Failure = Description;
+            return false;
+        }
+    }
+
+    // Random primes of each size...
+    const atomic<bool> Stop(false);
+    for(size_t Index = 0; Index < sizeof(Sizes) / sizeof(Sizes[0]); ++Index)
+    {
+        // Draw one...
+        const size_t Bits = Sizes[Index];
+        BigNumber Prime;
+        const bool Found =
+            RandomPrime(Generator, Bits, Stop, Prime, CorrectionDetected);
+
+        // Exactly as many bits as asked for, the top two set, and prime...
+        const size_t Top = Bits - 1;
+        const bool Sized = Found && BigNumberBits(Prime) == Bits &&
+            ((Prime[(Top - 1) / 64] >> ((Top - 1) % 64)) & 1);
+        if(!Sized || !IsProbablePrime(Generator, Prime, CorrectionDetected))
+        {
+            char Description[128];
+          ::snprintf(Description, sizeof(Description),
+                "random %zu-bit prime has %zu bits or is not prime",
+                Bits, Found ? BigNumberBits(Prime) : 0);
+            Failure = Description;
+            return false;
+        }
+    }
+
+    // Done...
+    return true;
+}
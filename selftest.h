@@ -0,0 +1,51 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Multiple include protection...
+#ifndef _SELF_TEST_H_
+#define _SELF_TEST_H_
+
+// Includes...
+
+    // Our headers...
+    #include "random.h"
+
+    // Standard C++...
+    #include <string>
+
+// Each check below returns true if it passed, or false with a description of
+//  what went wrong in the given string...
+
+// Draw a few million decisions at each of several probabilities, and check
+//  that every mean lies within six standard deviations of its probability...
+bool CheckBernoulli(RandomNumberGenerator &Generator, std::string &Failure);
+
+// Run the kernels of every instruction set level this host supports on the
+//  same input and check that they all agree with the baseline...
+bool CheckKernels(std::string &Failure);
+
+// Check Miller-Rabin against known primes and composites, including those
+//  that fool weaker tests, and that random primes have exactly the number of
+//  bits asked for with the top two set...
+bool CheckPrimes(RandomNumberGenerator &Generator, std::string &Failure);
+
+// Record a journal in a child process that is then killed without closing
+//  it, and check that every word it drew replays. Journals are written to the
+//  given directory...
+bool CheckJournalCrash(
+    RandomNumberGenerator  &Generator,
+    const std::string      &Directory,
+    std::string            &Failure);
+
+// Fork while replaying a journal, then check that the child can keep drawing,
+//  stop the replay, record a journal of its own, and that its mixed output
+//  differs from its parent's. Journals are written to the given directory...
+bool CheckFork(
+    RandomNumberGenerator  &Generator,
+    const std::string      &Directory,
+    std::string            &Failure);
+
+#endif
+
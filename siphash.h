@@ -0,0 +1,71 @@
+/*
+    node-rng, a library for accessing a true hardware random number generator
+    Copyright (C) 2016 Cherit.ee Inc
+*/
+
+// Multiple include protection...
+#ifndef _SIPHASH_H_
+#define _SIPHASH_H_
+
+// Includes...
+
+    // Standard C++...
+#ifdef __APPLE__
+    #include <tr1/cstdint>
+#else
+    #include <cstdint>
+#endif
+    #include <cstddef>
+
+// Rotate a 64-bit word left...
+static inline uint64_t RotateLeft(const uint64_t Value, const unsigned Bits)
+{
+    return (Value << Bits) | (Value >> (64 - Bits));
+}
+
+// One SipHash round over the four state words...
+#define SIP_ROUND(V0, V1, V2, V3)                                               \
+    do                                                                          \
+    {                                                                           \
+        V0 += V1; V1 = RotateLeft(V1, 13); V1 ^= V0; V0 = RotateLeft(V0, 32);   \
+        V2 += V3; V3 = RotateLeft(V3, 16); V3 ^= V2;                            \
+        V0 += V3; V3 = RotateLeft(V3, 21); V3 ^= V0;                            \
+        V2 += V1; V1 = RotateLeft(V1, 17); V1 ^= V2; V2 = RotateLeft(V2, 32);   \
+    }                                                                           \
+    while(false)
+
+// SipHash-2-4 of a message of whole words under the given key. Always inlined
+//  so that each instruction set specific kernel gets its own copy...
+static inline __attribute__((always_inline)) uint64_t SipHash(
+    const uint64_t Key[2], const uint64_t *Message, const size_t Words)
+{
+    // Initialize state from the key...
+    uint64_t V0 = Key[0] ^ 0x736f6d6570736575ULL;
+    uint64_t V1 = Key[1] ^ 0x646f72616e646f6dULL;
+    uint64_t V2 = Key[0] ^ 0x6c7967656e657261ULL;
+    uint64_t V3 = Key[1] ^ 0x7465646279746573ULL;
+
+    // Compress each message word, then the length...
+    for(size_t Index = 0; Index <= Words; ++Index)
+    {
+        const uint64_t Word = (Index < Words)
+            ? Message[Index] : static_cast<uint64_t>(Words * 8) << 56;
+        V3 ^= Word;
+        SIP_ROUND(V0, V1, V2, V3);
+        SIP_ROUND(V0, V1, V2, V3);
+        V0 ^= Word;
+    }
+
+    // Finalize...
+    V2 ^= 0xff;
+    SIP_ROUND(V0, V1, V2, V3);
+    SIP_ROUND(V0, V1, V2, V3);
+    SIP_ROUND(V0, V1, V2, V3);
+    SIP_ROUND(V0, V1, V2, V3);
+
+    // Done...
+    return V0 ^ V1 ^ V2 ^ V3;
+}
+
+#endif
+